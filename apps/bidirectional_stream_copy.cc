@@ -30,10 +30,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     input,
     Direction::In,
     [&] {
-      string data;
-      data.resize( outbound.writer().available_capacity() );
-      input.read( data );
-      outbound.writer().push( move( data ) );
+      fill( outbound.writer(), input );
       if ( input.eof() ) {
         outbound.writer().close();
       }
@@ -56,7 +53,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     Direction::Out,
     [&] {
       if ( outbound.reader().bytes_buffered() ) {
-        outbound.reader().pop( socket.write( outbound.reader().peek() ) );
+        drain( outbound.reader(), socket );
       }
       if ( outbound.reader().is_finished() ) {
         socket.shutdown( SHUT_WR );
@@ -80,10 +77,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     socket,
     Direction::In,
     [&] {
-      string data;
-      data.resize( inbound.writer().available_capacity() );
-      socket.read( data );
-      inbound.writer().push( move( data ) );
+      fill( inbound.writer(), socket );
       if ( socket.eof() ) {
         inbound.writer().close();
       }
@@ -106,7 +100,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     Direction::Out,
     [&] {
       if ( inbound.reader().bytes_buffered() ) {
-        inbound.reader().pop( output.write( inbound.reader().peek() ) );
+        drain( inbound.reader(), output );
       }
       if ( inbound.reader().is_finished() ) {
         output.close();
@@ -106,6 +106,7 @@ public:
   }
   void write( const TCPMessage& msg ) { _interface.send_datagram( wrap_tcp_in_ip( msg ), _next_hop ); }
   void tick( const size_t ms_since_last_tick ) { _interface.tick( ms_since_last_tick ); }
+  optional<uint64_t> ms_until_timer() const { return _interface.ms_until_timer(); }
   NetworkInterface& interface() { return _interface; }
 
   FileDescriptor& fd() { return sender_->sockets.first; }
@@ -10,6 +10,7 @@
 #include <random>
 #include <span>
 #include <string>
+#include <string_view>
 #include <tuple>
 
 using namespace std;
@@ -31,9 +32,22 @@ void show_usage( const char* argv0, const char* msg )
        << "   -s <port>       Set source port (client mode only)              (random)\n\n"
 
        << "   -w <winsz>      Use a window of <winsz> bytes                   " << TCPConfig::MAX_PAYLOAD_SIZE
-       << "\n\n"
+       << "\n"
+       << "   -W              Scale windows over 64 KB (RFC 7323)             (off)\n\n"
 
-       << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
+       << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n"
+       << "   -r              Adapt the RTO to measured round-trip times      (fixed)\n"
+       << "   -T              Send timestamps (RFC 7323)                      (off)\n"
+       << "   -D              Delay ACKs for in-order data (RFC 1122)         (off)\n"
+       << "   -N              Coalesce small writes (Nagle's algorithm)       (off)\n"
+       << "   -A              Avoid the silly window syndrome (RFC 1122)      (off)\n\n"
+
+       << "   -S              Use selective acknowledgments (SACK)            (off)\n"
+       << "   -f              Fast retransmit on three duplicate acks         (off)\n"
+       << "   -c <cc>         Use congestion control <cc> (reno or cubic)     (none)\n\n"
+
+       << "   -m              Keep stream bytes in mirrored rings             (ring/chunks)\n"
+       << "                   (double-mapped memory; suits large windows)\n\n"
 
        << "   -d <tundev>     Connect to tun <tundev>                         " << TUN_DFLT << "\n\n"
 
@@ -91,11 +105,60 @@ tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const span<char
       c_fsm.recv_capacity = strtol( args[curr + 1], nullptr, 0 );
       curr += 2;
 
+    } else if ( strncmp( "-W", args[curr], 3 ) == 0 ) {
+      c_fsm.window_scaling = true;
+      curr += 1;
+
     } else if ( strncmp( "-t", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -t requires one argument." );
       c_fsm.rt_timeout = strtol( args[curr + 1], nullptr, 0 );
       curr += 2;
 
+    } else if ( strncmp( "-r", args[curr], 3 ) == 0 ) {
+      c_fsm.adaptive_rto = true;
+      curr += 1;
+
+    } else if ( strncmp( "-T", args[curr], 3 ) == 0 ) {
+      c_fsm.timestamps = true;
+      curr += 1;
+
+    } else if ( strncmp( "-D", args[curr], 3 ) == 0 ) {
+      c_fsm.delayed_ack = true;
+      curr += 1;
+
+    } else if ( strncmp( "-N", args[curr], 3 ) == 0 ) {
+      c_fsm.nagle = true;
+      curr += 1;
+
+    } else if ( strncmp( "-A", args[curr], 3 ) == 0 ) {
+      c_fsm.sws_avoidance = true;
+      curr += 1;
+
+    } else if ( strncmp( "-S", args[curr], 3 ) == 0 ) {
+      c_fsm.sack = true;
+      curr += 1;
+
+    } else if ( strncmp( "-f", args[curr], 3 ) == 0 ) {
+      c_fsm.fast_retransmit = true;
+      curr += 1;
+
+    } else if ( strncmp( "-c", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -c requires one argument." );
+      const string_view algorithm = args[curr + 1];
+      if ( algorithm == "reno" ) {
+        c_fsm.congestion_control = CongestionControl::Algorithm::NewReno;
+      } else if ( algorithm == "cubic" ) {
+        c_fsm.congestion_control = CongestionControl::Algorithm::Cubic;
+      } else {
+        show_usage( args[0], "ERROR: -c must be reno or cubic." );
+        exit( 1 );
+      }
+      curr += 2;
+
+    } else if ( strncmp( "-m", args[curr], 3 ) == 0 ) {
+      c_fsm.send_storage = c_fsm.recv_storage = ByteStream::Storage::Mirrored;
+      curr += 1;
+
     } else if ( strncmp( "-d", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -t requires one argument." );
       tundev = args[curr + 1];
@@ -158,8 +221,10 @@ int main( int argc, char** argv )
     }
 
     auto [c_fsm, c_filt, listen, tun_dev_name] = get_config( args );
-    LossyTCPOverIPv4MinnowSocket tcp_socket( LossyFdAdapter<TCPOverIPv4OverTunFdAdapter>(
-      TCPOverIPv4OverTunFdAdapter( TunFD( tun_dev_name == nullptr ? TUN_DFLT : tun_dev_name ) ) ) );
+    TunFD tun { tun_dev_name == nullptr ? TUN_DFLT : tun_dev_name };
+    c_fsm.mss = TCPConfig::mss_for_mtu( tun.mtu() ); // fill each datagram up to the device's MTU
+    LossyTCPOverIPv4MinnowSocket tcp_socket(
+      LossyFdAdapter<TCPOverIPv4OverTunFdAdapter>( TCPOverIPv4OverTunFdAdapter( move( tun ) ) ) );
 
     if ( listen ) {
       tcp_socket.listen_and_accept( c_fsm, c_filt );
@@ -23,6 +23,7 @@ ttest(byte_stream_one_write)
 ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
+ttest(byte_stream_reserve)
 
 ttest(reassembler_single)
 ttest(reassembler_cap)
@@ -45,6 +46,10 @@ ttest(recv_reorder)
 ttest(recv_reorder_more)
 ttest(recv_close)
 ttest(recv_special)
+ttest(recv_sack)
+ttest(recv_window_scale)
+ttest(recv_timestamps)
+ttest(recv_sws)
 
 ttest(send_connect)
 ttest(send_transmit)
@@ -53,11 +58,26 @@ ttest(send_ack)
 ttest(send_close)
 ttest(send_retx)
 ttest(send_extra)
+ttest(send_sack)
+ttest(send_congestion)
+ttest(send_rto)
+ttest(send_fast_retransmit)
+ttest(send_window_scale)
+ttest(send_timestamps)
+ttest(send_mss)
+ttest(send_nagle)
+ttest(send_sws)
 
 ttest(net_interface)
 
 ttest(router)
 
+ttest(tcp_engine)
+ttest(tcp_listener)
+ttest(tcp_peer)
+ttest(tcp_sharded_engine)
+ttest(timer_wheel)
+
 ttest(no_skip)
 
 add_custom_target (check0 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 15 -R 'webget|^byte_stream_|^no_skip')
@@ -94,3 +114,7 @@ set_tests_properties(${compile_name_opt} PROPERTIES FIXTURES_SETUP compile_opt)
 
 stest(byte_stream_speed_test)
 stest(reassembler_speed_test)
+stest(spsc_byte_stream_speed_test)
+stest(tcp_speed_test)
+stest(tcp_pacing_speed_test)
+stest(tcp_sharded_speed_test)
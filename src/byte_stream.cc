@@ -1,24 +1,158 @@
 #include "byte_stream.hh"
 
+#include <algorithm>
+
 using namespace std;
 
-ByteStream::ByteStream( uint64_t capacity ) : capacity_( capacity ) {}
+namespace {
+// Smallest allocation for the circular buffer, so that tiny pushes don't cause repeated regrowth.
+constexpr uint64_t MIN_BUFFER_SIZE = 4096;
+
+// Largest space reserve() hands out at once in Chunks mode, so each chunk stays bounded in size.
+constexpr uint64_t MAX_RESERVATION_SIZE = 65536;
+} // namespace
+
+ByteStream::ByteStream( uint64_t capacity, Storage storage ) : capacity_( capacity ), storage_( storage )
+{
+  if ( storage_ == Storage::Mirrored ) {
+    mirror_.emplace( capacity_ );
+  }
+}
+
+char* ByteStream::ring()
+{
+  return storage_ == Storage::Mirrored ? mirror_->data() : buffer_.data();
+}
+
+const char* ByteStream::ring() const
+{
+  return storage_ == Storage::Mirrored ? mirror_->data() : buffer_.data();
+}
+
+uint64_t ByteStream::ring_size() const
+{
+  return storage_ == Storage::Mirrored ? mirror_->size() : buffer_.size();
+}
+
+uint64_t ByteStream::make_room( uint64_t len )
+{
+  const uint64_t buffered = bytes_pushed_ - bytes_popped_;
+
+  // The Ring buffer grows on demand; the Mirrored one is mapped at full size up front.
+  if ( storage_ == Storage::Ring and buffered + len > buffer_.size() ) {
+    grow( buffered + len );
+  }
+
+  // The free space starts right after the buffered bytes, which may have wrapped around the end of the ring.
+  const uint64_t tail = head_ + buffered;
+  return tail >= ring_size() ? tail - ring_size() : tail;
+}
+
+uint64_t ByteStream::contiguous( uint64_t offset ) const
+{
+  // The Mirrored ring's second mapping continues where the first one ends, so nothing ever wraps.
+  return storage_ == Storage::Mirrored ? ring_size() : ring_size() - offset;
+}
+
+void ByteStream::grow( uint64_t min_size )
+{
+  // Double the allocation (amortized O(1) per byte), but never beyond the stream's capacity.
+  const uint64_t new_size = min( capacity_, max( { min_size, 2 * buffer_.size(), MIN_BUFFER_SIZE } ) );
+  const uint64_t buffered = bytes_pushed_ - bytes_popped_;
+
+  // Copy the buffered bytes (which may wrap around the end of the old buffer) to the front of the new one.
+  string bigger( new_size, 0 );
+  const uint64_t first_part = min( buffered, buffer_.size() - head_ );
+  buffer_.copy( bigger.data(), first_part, head_ );
+  buffer_.copy( bigger.data() + first_part, buffered - first_part, 0 );
+
+  buffer_ = move( bigger );
+  head_ = 0;
+}
 
 void Writer::push( string data )
 {
   // If the stream is closed, we cannot push any more data.
-  if (is_closed()) {
+  if ( is_closed() ) {
     return;
   }
 
-  // calculate the number of bytes we can push
-  size_t can_accept = min(available_capacity(), data.size());
-  
   // only push as much as we can
-  if (can_accept > 0) {
-    buffer_.append(data.substr(0, can_accept));
-    bytes_pushed_ += can_accept;
+  const uint64_t len = min( available_capacity(), static_cast<uint64_t>( data.size() ) );
+  if ( len == 0 ) {
+    return;
+  }
+  reserved_ = 0; // the pushed bytes may land in space handed out by reserve()
+
+  // In Chunks mode, the string itself becomes the stored chunk (trimmed in place if it doesn't all fit).
+  if ( storage_ == Storage::Chunks ) {
+    data.resize( len );
+    chunks_.push_back( move( data ) );
+    bytes_pushed_ += len;
+    return;
+  }
+
+  // Copy into the free space, wrapping around to the front of the ring if necessary.
+  const uint64_t tail = make_room( len );
+  const uint64_t first_part = min( len, contiguous( tail ) );
+  data.copy( ring() + tail, first_part, 0 );
+  data.copy( ring(), len - first_part, first_part );
+
+  bytes_pushed_ += len;
+}
+
+span<char> Writer::reserve( uint64_t len )
+{
+  reserved_ = 0;
+  len = min( len, available_capacity() );
+  if ( is_closed() or len == 0 ) {
+    return {};
   }
+
+  // In Chunks mode, the reserved space is a scratch string that is reused across reservations; it is
+  // only enlarged (and zero-filled) when it is too small, and never beyond MAX_RESERVATION_SIZE.
+  if ( storage_ == Storage::Chunks ) {
+    reserved_ = min( len, MAX_RESERVATION_SIZE );
+    if ( reservation_.size() < reserved_ ) {
+      reservation_.resize( reserved_ );
+    }
+    return { reservation_.data(), reserved_ };
+  }
+
+  // Grow the ring only once it is full (and then geometrically, like push()), so that asking for the
+  // whole available capacity, as fill() does, doesn't enlarge the buffer to the stream's capacity.
+  const uint64_t buffered = bytes_pushed_ - bytes_popped_;
+  const uint64_t tail = make_room( ring_size() > buffered ? min( len, ring_size() - buffered ) : 1 );
+
+  // Hand out only the contiguous run of free space after the buffered bytes, which stops at the end of the
+  // ring or, if the buffered bytes have wrapped around, at the first of them. (Any free space at the front of
+  // the ring is left for the next reserve().)
+  reserved_ = min( { len, ring_size() - buffered, contiguous( tail ) } );
+  return { ring() + tail, reserved_ };
+}
+
+void Writer::commit( uint64_t len )
+{
+  len = min( len, reserved_ );
+  reserved_ = 0;
+  if ( is_closed() or len == 0 ) {
+    return;
+  }
+
+  // A mostly-filled scratch string becomes the chunk itself; a small fill is copied into a right-sized
+  // chunk instead, so the stream never holds much more memory than the bytes it buffers.
+  if ( storage_ == Storage::Chunks ) {
+    if ( 2 * len >= reservation_.size() ) {
+      reservation_.resize( len );
+      chunks_.push_back( move( reservation_ ) );
+      reservation_ = string {};
+    } else {
+      chunks_.emplace_back( reservation_.data(), len );
+    }
+  }
+
+  // Otherwise, the bytes are already in place in the ring, right after the buffered ones.
+  bytes_pushed_ += len;
 }
 
 void Writer::close()
@@ -33,8 +167,7 @@ bool Writer::is_closed() const
 
 uint64_t Writer::available_capacity() const
 {
-  // Calculate the available capacity
-  return capacity_ - (bytes_pushed_ - bytes_popped_); // Return the available capacity.
+  return capacity_ - ( bytes_pushed_ - bytes_popped_ ); // Return the available capacity.
 }
 
 uint64_t Writer::bytes_pushed() const
@@ -44,16 +177,72 @@ uint64_t Writer::bytes_pushed() const
 
 string_view Reader::peek() const
 {
-  return string_view(buffer_); // Return a view of the current buffer.
+  if ( storage_ == Storage::Chunks ) {
+    return chunks_.empty() ? string_view {} : string_view( chunks_.front() ).substr( head_ );
+  }
+
+  // Return the contiguous run of buffered bytes that starts at head_ (stopping at the wrap point, if any).
+  return { ring() + head_, min( bytes_buffered(), contiguous( head_ ) ) };
+}
+
+vector<string_view> Reader::peek_all() const
+{
+  vector<string_view> views;
+
+  if ( storage_ == Storage::Chunks ) {
+    views.reserve( chunks_.size() );
+    for ( const auto& chunk : chunks_ ) {
+      views.emplace_back( chunk );
+    }
+    if ( not views.empty() ) {
+      views.front().remove_prefix( head_ );
+    }
+    return views;
+  }
+
+  // At most two runs: from head_ to the end of the ring, then any part that wrapped around to the front.
+  const string_view first = peek();
+  if ( not first.empty() ) {
+    views.push_back( first );
+  }
+  if ( first.size() < bytes_buffered() ) {
+    views.emplace_back( ring(), bytes_buffered() - first.size() );
+  }
+  return views;
 }
 
 void Reader::pop( uint64_t len )
 {
   // ensure we don't pop more than we have
-  len = min(len, bytes_buffered());
+  len = min( len, bytes_buffered() );
+
+  if ( storage_ == Storage::Chunks ) {
+    bytes_popped_ += len;
+    // Discard every chunk that is now fully consumed.
+    while ( len > 0 ) {
+      const uint64_t rest_of_chunk = chunks_.front().size() - head_;
+      if ( len < rest_of_chunk ) {
+        head_ += len;
+        break;
+      }
+      len -= rest_of_chunk;
+      chunks_.pop_front();
+      head_ = 0;
+    }
+    return;
+  }
 
-  buffer_.erase(0, len); // Remove `len` bytes from the buffer.
+  head_ += len;
+  if ( head_ >= ring_size() ) {
+    head_ -= ring_size();
+  }
   bytes_popped_ += len; // Update the total number of bytes popped.
+
+  // Once the buffer drains, rewind so the next pushes are stored (and peeked) contiguously.
+  // (Not while the writer holds reserved space, which must stay right after the buffered bytes.)
+  if ( bytes_buffered() == 0 and reserved_ == 0 ) {
+    head_ = 0;
+  }
 }
 
 bool Reader::is_finished() const
@@ -71,4 +260,3 @@ uint64_t Reader::bytes_popped() const
 {
   return bytes_popped_; // Return the total number of bytes popped from the stream.
 }
-
@@ -1,16 +1,31 @@
 #pragma once
 
+#include "mirrored_buffer.hh"
+
 #include <cstdint>
+#include <deque>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
+class FileDescriptor;
 class Reader;
 class Writer;
 
 class ByteStream
 {
 public:
-  explicit ByteStream( uint64_t capacity );
+  // How the stream holds buffered bytes
+  enum class Storage : uint8_t
+  {
+    Ring,    // Copy pushed bytes into one circular buffer (cheap small pops)
+    Chunks,  // Take ownership of each pushed string as its own chunk (no copies; peek returns one chunk)
+    Mirrored // Copy pushed bytes into a double-mapped ring (peek returns every buffered byte, for large windows)
+  };
+
+  explicit ByteStream( uint64_t capacity, Storage storage = Storage::Ring );
 
   // Helper functions (provided) to access the ByteStream's Reader and Writer interfaces
   Reader& reader();
@@ -24,12 +39,26 @@ public:
 protected:
   // Please add any additional state to the ByteStream here, and not to the Writer and Reader interfaces.
   uint64_t capacity_;
+  Storage storage_;
   bool error_ {};
 
-  std::string buffer_ {}; // Buffer to hold the data
-  bool closed_ {false};      // Flag to indicate if the stream is closed
-  uint64_t bytes_pushed_ {0}; // Number of bytes pushed to the stream
-  uint64_t bytes_popped_ {0}; // Number of bytes popped from the stream
+  std::string buffer_ {};                   // Ring: circular buffer (grown on demand, up to capacity_)
+  std::optional<MirroredBuffer> mirror_ {}; // Mirrored: ring of at least capacity_ bytes, mapped twice
+  std::deque<std::string> chunks_ {};       // Chunks: the pushed strings, in order
+  std::string reservation_ {};              // Chunks: scratch space handed out by reserve()
+  uint64_t reserved_ {};                    // Bytes handed out by the last reserve() and not yet committed
+  uint64_t head_ {};                        // Offset of the next byte to pop (in the ring or chunks_.front())
+  bool closed_ {};                          // Flag to indicate if the stream is closed
+  uint64_t bytes_pushed_ {};                // Number of bytes pushed to the stream
+  uint64_t bytes_popped_ {};                // Number of bytes popped from the stream
+
+  // Helpers for the Ring and Mirrored storage
+  char* ring();                                 // Start of the circular buffer
+  const char* ring() const;                     // Start of the circular buffer
+  uint64_t ring_size() const;                   // Size of the circular buffer
+  uint64_t make_room( uint64_t len );           // Ensure room for `len` more bytes; returns where they go
+  uint64_t contiguous( uint64_t offset ) const; // How many bytes from `offset` are contiguous in memory
+  void grow( uint64_t min_size );               // Ring: enlarge buffer_ to `min_size` or more, unwrapping it
 };
 
 class Writer : public ByteStream
@@ -38,6 +67,12 @@ public:
   void push( std::string data ); // Push data to stream, but only as much as available capacity allows.
   void close();                  // Signal that the stream has reached its ending. Nothing more will be written.
 
+  // In-place writes: reserve() returns writable space inside the stream (up to `len` bytes, possibly fewer),
+  // and commit() publishes the first `len` bytes written there. Another push() or reserve() discards the
+  // uncommitted space.
+  std::span<char> reserve( uint64_t len );
+  void commit( uint64_t len );
+
   bool is_closed() const;              // Has the stream been closed?
   uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
   uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
@@ -46,8 +81,9 @@ public:
 class Reader : public ByteStream
 {
 public:
-  std::string_view peek() const; // Peek at the next bytes in the buffer
-  void pop( uint64_t len );      // Remove `len` bytes from the buffer
+  std::string_view peek() const;                // Peek at the next bytes in the buffer
+  std::vector<std::string_view> peek_all() const; // Peek at every buffered byte, as a list of contiguous views
+  void pop( uint64_t len );                     // Remove `len` bytes from the buffer
 
   bool is_finished() const;        // Is the stream finished (closed and fully popped)?
   uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
@@ -59,3 +95,15 @@ public:
  * from a ByteStream Reader into a string;
  */
 void read( Reader& reader, uint64_t max_len, std::string& out );
+
+/*
+ * drain: A helper function that writes as many buffered bytes as possible from a ByteStream Reader
+ * into a file descriptor with a single writev(2), pops them, and returns how many were written.
+ */
+uint64_t drain( Reader& reader, FileDescriptor& fd );
+
+/*
+ * fill: A helper function that reads from a file descriptor directly into a ByteStream Writer's
+ * reserved space (as much as fits, with a single read(2)) and returns how many bytes were pushed.
+ */
+uint64_t fill( Writer& writer, FileDescriptor& fd );
@@ -1,5 +1,7 @@
 #include "byte_stream.hh"
+#include "file_descriptor.hh"
 
+#include <climits>
 #include <cstdint>
 #include <stdexcept>
 
@@ -26,6 +28,43 @@ void read( Reader& reader, uint64_t max_len, string& out )
   }
 }
 
+/*
+ * drain: A helper function that writes as many buffered bytes as possible from a ByteStream Reader
+ * into a file descriptor with a single writev(2), pops them, and returns how many were written.
+ */
+uint64_t drain( Reader& reader, FileDescriptor& fd )
+{
+  auto views = reader.peek_all();
+  if ( views.empty() ) {
+    return 0;
+  }
+
+  // writev(2) accepts at most IOV_MAX buffers; anything beyond that waits for the next call.
+  if ( views.size() > IOV_MAX ) {
+    views.resize( IOV_MAX );
+  }
+
+  const uint64_t bytes_written = fd.write( views );
+  reader.pop( bytes_written );
+  return bytes_written;
+}
+
+/*
+ * fill: A helper function that reads from a file descriptor directly into a ByteStream Writer's
+ * reserved space (as much as fits, with a single read(2)) and returns how many bytes were pushed.
+ */
+uint64_t fill( Writer& writer, FileDescriptor& fd )
+{
+  const span<char> space = writer.reserve( writer.available_capacity() );
+  if ( space.empty() ) {
+    return 0;
+  }
+
+  const uint64_t bytes_read = fd.read( space );
+  writer.commit( bytes_read );
+  return bytes_read;
+}
+
 Reader& ByteStream::reader()
 {
   static_assert( sizeof( Reader ) == sizeof( ByteStream ),
@@ -0,0 +1,133 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+unique_ptr<CongestionControl> CongestionControl::make( Algorithm algorithm, uint64_t mss )
+{
+  switch ( algorithm ) {
+    case Algorithm::NewReno:
+      return make_unique<NewReno>( mss );
+    case Algorithm::Cubic:
+      return make_unique<Cubic>( mss );
+    case Algorithm::None:
+      break;
+  }
+  return nullptr;
+}
+
+namespace {
+// The initial window (RFC 5681 section 3.1): 2 to 4 segments, depending on their size
+uint64_t initial_window( uint64_t mss )
+{
+  return mss > 2190 ? 2 * mss : ( mss > 1095 ? 3 * mss : 4 * mss );
+}
+} // namespace
+
+CongestionControl::CongestionControl( uint64_t mss ) : mss_( mss ), cwnd_( initial_window( mss ) ) {}
+
+void CongestionControl::set_mss( uint64_t mss )
+{
+  mss_ = mss;
+  cwnd_ = initial_window( mss );
+}
+
+void CongestionControl::slow_start( uint64_t bytes_acked )
+{
+  // Appropriate Byte Counting (RFC 3465) with L = 1 segment
+  cwnd_ += min( bytes_acked, mss_ );
+}
+
+void NewReno::on_ack( uint64_t bytes_acked, uint64_t now_ms [[maybe_unused]] )
+{
+  if ( in_slow_start() ) {
+    slow_start( bytes_acked );
+    return;
+  }
+
+  // Congestion avoidance: one more segment for each window's worth of acknowledged bytes
+  bytes_acked_ += bytes_acked;
+  if ( bytes_acked_ >= cwnd_ ) {
+    bytes_acked_ -= cwnd_;
+    cwnd_ += mss_;
+  }
+}
+
+void NewReno::on_loss( uint64_t bytes_in_flight, uint64_t now_ms [[maybe_unused]] )
+{
+  ssthresh_ = max( bytes_in_flight / 2, 2 * mss_ );
+  cwnd_ = ssthresh_;
+  bytes_acked_ = 0;
+}
+
+void NewReno::on_rto( uint64_t bytes_in_flight, uint64_t now_ms [[maybe_unused]] )
+{
+  ssthresh_ = max( bytes_in_flight / 2, 2 * mss_ );
+  cwnd_ = mss_; // the loss window
+  bytes_acked_ = 0;
+}
+
+void Cubic::on_rtt_sample( uint64_t rtt_ms )
+{
+  srtt_ms_ = srtt_ms_ ? ( 7 * srtt_ms_ + rtt_ms ) / 8 : rtt_ms;
+}
+
+void Cubic::on_ack( uint64_t bytes_acked, uint64_t now_ms )
+{
+  if ( in_slow_start() ) {
+    slow_start( bytes_acked );
+    return;
+  }
+
+  const double segment = static_cast<double>( mss_ );
+  const double cwnd = static_cast<double>( cwnd_ ) / segment;
+  const double acked = static_cast<double>( bytes_acked ) / segment;
+
+  if ( not epoch_started_ ) {
+    // First ack of congestion avoidance (RFC 9438 section 4.2). Without a previous loss, start the curve
+    // at its plateau.
+    epoch_started_ = true;
+    epoch_start_ms_ = now_ms;
+    w_max_ = max( w_max_, cwnd );
+    k_ = w_max_ > cwnd ? cbrt( ( w_max_ - cwnd ) / C ) : 0;
+    w_est_ = cwnd;
+  }
+
+  // Where the cubic function will be one RTT from now (section 4.2)
+  const double t = static_cast<double>( now_ms - epoch_start_ms_ + srtt_ms_ ) / 1000;
+  const double w_cubic = C * pow( t - k_, 3 ) + w_max_;
+  const double target = clamp( w_cubic, cwnd, 1.5 * cwnd );
+
+  // What standard TCP would have done (section 4.3)
+  constexpr double alpha = 3 * ( 1 - BETA ) / ( 1 + BETA );
+  w_est_ += alpha * acked / cwnd;
+
+  const double next = w_cubic < w_est_ ? w_est_ : cwnd + ( target - cwnd ) / cwnd * acked;
+  cwnd_ = max( cwnd_, static_cast<uint64_t>( next * segment ) );
+}
+
+void Cubic::reduce( uint64_t now_ms )
+{
+  const double cwnd = static_cast<double>( cwnd_ ) / static_cast<double>( mss_ );
+
+  // Fast convergence (section 4.7): if the window is still shrinking, release bandwidth to newer flows
+  w_max_ = cwnd < w_max_ ? cwnd * ( 1 + BETA ) / 2 : cwnd;
+
+  ssthresh_ = max( static_cast<uint64_t>( static_cast<double>( cwnd_ ) * BETA ), 2 * mss_ );
+  epoch_started_ = false;
+  epoch_start_ms_ = now_ms;
+}
+
+void Cubic::on_loss( uint64_t bytes_in_flight [[maybe_unused]], uint64_t now_ms )
+{
+  reduce( now_ms );
+  cwnd_ = ssthresh_;
+}
+
+void Cubic::on_rto( uint64_t bytes_in_flight [[maybe_unused]], uint64_t now_ms )
+{
+  reduce( now_ms );
+  cwnd_ = mss_;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+/*
+ * A CongestionControl algorithm decides how many bytes the TCPSender may have in flight (the
+ * congestion window, cwnd), based on what the sender tells it about acknowledgments, losses and
+ * round-trip times. The sender never has more than min(cwnd, receiver's window) bytes in flight.
+ *
+ * Times are in milliseconds on the sender's clock (the sum of the intervals passed to tick()).
+ */
+class CongestionControl
+{
+public:
+  enum class Algorithm : uint8_t
+  {
+    None,    // no congestion window: only the receiver's window limits the sender
+    NewReno, // RFC 5681 slow start and congestion avoidance
+    Cubic,   // RFC 9438
+  };
+
+  // Make the given algorithm for a connection that sends segments of up to `mss` bytes (nullptr for None)
+  static std::unique_ptr<CongestionControl> make( Algorithm algorithm, uint64_t mss );
+
+  explicit CongestionControl( uint64_t mss );
+
+  uint64_t window() const { return cwnd_; }                 // The congestion window, in bytes
+  bool in_slow_start() const { return cwnd_ < ssthresh_; } // Is the window still growing exponentially?
+
+  // The handshake settled on a different segment size (before any data was sent): restart from its initial window
+  void set_mss( uint64_t mss );
+
+  // `bytes_acked` bytes were newly acknowledged (not called during loss recovery)
+  virtual void on_ack( uint64_t bytes_acked, uint64_t now_ms ) = 0;
+
+  // A loss was detected while `bytes_in_flight` bytes were outstanding (once per window of data)
+  virtual void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) = 0;
+
+  // The retransmission timer expired
+  virtual void on_rto( uint64_t bytes_in_flight, uint64_t now_ms ) = 0;
+
+  // A segment that was sent once was acknowledged `rtt_ms` after it was sent
+  virtual void on_rtt_sample( uint64_t rtt_ms [[maybe_unused]] ) {}
+
+  virtual ~CongestionControl() = default;
+  CongestionControl( const CongestionControl& other ) = default;
+  CongestionControl& operator=( const CongestionControl& other ) = default;
+  CongestionControl( CongestionControl&& other ) = default;
+  CongestionControl& operator=( CongestionControl&& other ) = default;
+
+protected:
+  uint64_t mss_;                   // sender maximum segment size
+  uint64_t cwnd_;                  // congestion window
+  uint64_t ssthresh_ = UINT64_MAX; // slow-start threshold
+
+  void slow_start( uint64_t bytes_acked ); // grow cwnd_ by up to one segment per ack
+};
+
+// RFC 5681: cwnd grows by about one segment per RTT, and halves on each loss.
+class NewReno : public CongestionControl
+{
+public:
+  using CongestionControl::CongestionControl;
+
+  void on_ack( uint64_t bytes_acked, uint64_t now_ms ) override;
+  void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_rto( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+
+private:
+  uint64_t bytes_acked_ {}; // bytes acked since cwnd_ last grew in congestion avoidance
+};
+
+// RFC 9438: after a loss, cwnd follows a cubic function of the time since the loss, which returns quickly
+// to the window where the loss happened, probes carefully around it, then grows fast again.
+class Cubic : public CongestionControl
+{
+public:
+  using CongestionControl::CongestionControl;
+
+  void on_ack( uint64_t bytes_acked, uint64_t now_ms ) override;
+  void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_rto( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_rtt_sample( uint64_t rtt_ms ) override;
+
+private:
+  static constexpr double C = 0.4;
+  static constexpr double BETA = 0.7;
+
+  bool epoch_started_ {}; // has congestion avoidance begun since the last loss?
+  uint64_t epoch_start_ms_ {};
+  double w_max_ {}; // window before the last reduction, in segments
+  double k_ {};     // seconds the cubic function takes to return to w_max_
+  double w_est_ {}; // what Reno's window would be (the "Reno-friendly" region), in segments
+  uint64_t srtt_ms_ {};
+
+  void reduce( uint64_t now_ms );
+};
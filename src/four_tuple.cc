@@ -0,0 +1,51 @@
+#include "four_tuple.hh"
+
+#include "address.hh"
+
+#include <array>
+
+using namespace std;
+
+string FourTuple::to_string() const
+{
+  return Address::from_ipv4_numeric( local_address ).ip() + ":" + std::to_string( local_port ) + " <-> "
+         + Address::from_ipv4_numeric( remote_address ).ip() + ":" + std::to_string( remote_port );
+}
+
+uint32_t FourTuple::rss_hash() const
+{
+  // The key from Microsoft's RSS specification, which most NICs use by default
+  static constexpr array<uint8_t, 40> key { 0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2, 0x41, 0x67,
+                                            0x25, 0x3d, 0x43, 0xa3, 0x8f, 0xb0, 0xd0, 0xca, 0x2b, 0xcb,
+                                            0xae, 0x7b, 0x30, 0xb4, 0x77, 0xcb, 0x2d, 0xa3, 0x80, 0x30,
+                                            0xf2, 0x0c, 0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa };
+
+  // The input is the segment's source address, destination address, source port and destination port (in
+  // network byte order); an incoming segment's source is the remote side
+  array<uint8_t, 12> input {};
+  size_t length = 0;
+  const auto append = [&]( uint32_t value, size_t bytes ) {
+    for ( size_t i = bytes; i > 0; i-- ) {
+      input.at( length++ ) = static_cast<uint8_t>( value >> ( 8 * ( i - 1 ) ) );
+    }
+  };
+  append( remote_address, 4 );
+  append( local_address, 4 );
+  append( remote_port, 2 );
+  append( local_port, 2 );
+
+  // For every set bit of the input, XOR in the 32 bits of the key that start at that bit
+  uint32_t hash = 0;
+  uint32_t window = static_cast<uint32_t>( key[0] ) << 24 | key[1] << 16 | key[2] << 8 | key[3];
+  size_t next_key_bit = 32;
+  for ( const uint8_t byte : input ) {
+    for ( int bit = 7; bit >= 0; bit-- ) {
+      if ( byte >> bit & 1 ) {
+        hash ^= window;
+      }
+      window = window << 1 | ( key.at( next_key_bit / 8 ) >> ( 7 - next_key_bit % 8 ) & 1 );
+      next_key_bit++;
+    }
+  }
+  return hash;
+}
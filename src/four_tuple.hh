@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// The addresses and ports that identify a TCP connection, from our side of it
+struct FourTuple
+{
+  uint32_t local_address {};
+  uint16_t local_port {};
+  uint32_t remote_address {};
+  uint16_t remote_port {};
+
+  bool operator==( const FourTuple& other ) const = default;
+
+  std::string to_string() const;
+
+  // The Toeplitz hash that a NIC's receive-side scaling (RSS) computes over an incoming segment's addresses and
+  // ports (with the standard key), to spread connections across cores
+  uint32_t rss_hash() const;
+};
+
+template<>
+struct std::hash<FourTuple>
+{
+  size_t operator()( const FourTuple& tuple ) const noexcept
+  {
+    // Mix all 96 bits (a finalizer like splitmix64's), so that nearby ports don't land in nearby buckets
+    uint64_t x = ( static_cast<uint64_t>( tuple.local_address ) << 32 | tuple.remote_address )
+                 ^ ( static_cast<uint64_t>( tuple.local_port ) << 16 | tuple.remote_port ) * 0x9e3779b97f4a7c15;
+    x = ( x ^ ( x >> 30 ) ) * 0xbf58476d1ce4e5b9;
+    x = ( x ^ ( x >> 27 ) ) * 0x94d049bb133111eb;
+    return x ^ ( x >> 31 );
+  }
+};
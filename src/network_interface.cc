@@ -37,7 +37,7 @@ void NetworkInterface::send_datagram( const InternetDatagram& dgram, const Addre
   auto arp_it = arp_cache_.find( next_hop_ip );
   if ( arp_it != arp_cache_.end() ) {
     // If found, get the Ethernet address and transmit the datagram immediately
-    const EthernetAddress& next_hop_ethernet_address = arp_it->second.ethernet_address;
+    const EthernetAddress& next_hop_ethernet_address = arp_it->second;
     transmit( { { next_hop_ethernet_address, ethernet_address_, EthernetHeader::TYPE_IPv4 }, serialize( dgram ) } );
     return;
   }
@@ -46,14 +46,14 @@ void NetworkInterface::send_datagram( const InternetDatagram& dgram, const Addre
   pending_datagrams_[next_hop_ip].emplace_back( dgram );
 
   // Check if an ARP request for this IP is already pending
-  if ( pending_datagram_timers_.find( next_hop_ip )!= pending_datagram_timers_.end() ) {
+  if ( arp_request_timers_.deadline( next_hop_ip ).has_value() ) {
     // If yes, do nothing; an ARP request is already in flight
     return;
   }
 
   // If no ARP request is pending, send one
   // Start a timer to track the ARP request
-  pending_datagram_timers_.emplace( next_hop_ip, Timer {} );
+  arp_request_timers_.schedule( next_hop_ip, now_ms_ + ARP_REQUEST_PERIOD_ms );
 
   // Construct the ARP request message
   const ARPMessage arp_request = {
@@ -100,7 +100,8 @@ void NetworkInterface::recv_frame( EthernetFrame frame )
     const AddressNumber sender_ip = msg.sender_ip_address;
     const EthernetAddress sender_eth = msg.sender_ethernet_address;
     // Add or update the entry in the ARP cache, resetting its timer
-    arp_cache_[sender_ip] = { sender_eth, 0 };
+    arp_cache_[sender_ip] = sender_eth;
+    arp_cache_timers_.schedule( sender_ip, now_ms_ + ARP_ENTRY_TTL_ms );
 
     // Check if this is an ARP request specifically for our IP address
     if ( msg.opcode == ARPMessage::OPCODE_REQUEST && msg.target_ip_address == ip_address_.ipv4_numeric() ) {
@@ -128,42 +129,31 @@ void NetworkInterface::recv_frame( EthernetFrame frame )
       // Remove the entry from the pending datagrams map
       pending_datagrams_.erase(it);
       // Remove the corresponding timer for the ARP request
-      pending_datagram_timers_.erase(sender_ip);
+      arp_request_timers_.cancel(sender_ip);
     }
   }
 }
 
 
-//! \param[in] ms_since_last_tick the number of milliseconds since the last call to this method
-void NetworkInterface::tick( const size_t ms_since_last_tick )
+optional<uint64_t> NetworkInterface::ms_until_timer() const
 {
-  // Iterate through the ARP cache to expire old entries
-  for ( auto it = arp_cache_.begin(); it != arp_cache_.end(); ) {
-    // Increment the timer for each entry
-    it->second.timer += ms_since_last_tick;
-    // Check if the entry has exceeded its time-to-live (TTL)
-    if ( it->second.timer >= ARP_ENTRY_TTL_ms ) {
-      // If expired, remove the entry from the cache
-      it = arp_cache_.erase( it );
-    } else {
-      // Otherwise, move to the next entry
-      it++;
+  optional<uint64_t> result;
+  for ( const auto* timers : { &arp_cache_timers_, &arp_request_timers_ } ) {
+    if ( const auto when = timers->next_event() ) {
+      result = min( result.value_or( UINT64_MAX ), *when - min( *when, now_ms_ ) );
     }
   }
+  return result;
+}
 
-  // Iterate through the pending ARP request timers to expire old requests
-  for ( auto it = pending_datagram_timers_.begin(); it != pending_datagram_timers_.end(); ) {
-    // Increment the timer for each pending request
-    it->second += ms_since_last_tick;
-    // Check if the request has exceeded its timeout period
-    if ( it->second >= ARP_REQUEST_PERIOD_ms ) {
-      // If expired, remove the corresponding pending datagrams
-      pending_datagrams_.erase( it->first );
-      // Remove the timer entry itself
-      it = pending_datagram_timers_.erase( it );
-    } else {
-      // Otherwise, move to the next entry
-      it++;
-    }
-  }
+//! \param[in] ms_since_last_tick the number of milliseconds since the last call to this method
+void NetworkInterface::tick( const size_t ms_since_last_tick )
+{
+  now_ms_ += ms_since_last_tick;
+
+  // Remove the ARP cache entries that have exceeded their time-to-live (TTL)
+  arp_cache_timers_.advance( now_ms_, [this]( AddressNumber ip ) { arp_cache_.erase( ip ); } );
+
+  // Give up on the ARP requests that have gone unanswered, and the datagrams waiting for them
+  arp_request_timers_.advance( now_ms_, [this]( AddressNumber ip ) { pending_datagrams_.erase( ip ); } );
 }
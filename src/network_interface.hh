@@ -3,8 +3,10 @@
 #include "address.hh"
 #include "ethernet_frame.hh"
 #include "ipv4_datagram.hh"
+#include "timer_wheel.hh"
 
 #include <memory>
+#include <optional>
 #include <queue>
 #include <unordered_map>
 
@@ -61,6 +63,10 @@ public:
   // Called periodically when time elapses
   void tick( size_t ms_since_last_tick );
 
+  // How many milliseconds until tick() next has something to do (expire an ARP cache entry or an unanswered
+  // ARP request). There is no value if nothing is waiting.
+  std::optional<uint64_t> ms_until_timer() const;
+
   // Accessors
   const std::string& name() const { return name_; }
   const OutputPort& output() const { return *port_; }
@@ -87,19 +93,16 @@ private:
   // ARP entry validity period and retransmission interval (30s / 5s recommended by RFC826)
   static constexpr size_t ARP_ENTRY_TTL_ms      = 30'000;  // 30 s
   static constexpr size_t ARP_REQUEST_PERIOD_ms = 5'000;   // 5 s
-  using Timer = uint64_t;
   using AddressNumber = uint32_t;
 
-  struct ArpEntry
-  {
-    EthernetAddress ethernet_address;
-    Timer timer;
-  };
-
   // ARP cache: maps IP addresses to Ethernet addresses
-  std::unordered_map<AddressNumber, ArpEntry> arp_cache_ {};
+  std::unordered_map<AddressNumber, EthernetAddress> arp_cache_ {};
   // Pending datagrams: maps IP addresses to datagrams waiting for ARP replies
   std::unordered_map<AddressNumber, std::vector<InternetDatagram>> pending_datagrams_ {};
-  // Pending datagram timers: maps IP addresses to timers for retransmitting ARP requests
-  std::unordered_map<AddressNumber, Timer> pending_datagram_timers_ {};
+
+  // Time passed to tick(), and when each ARP cache entry and each ARP request in flight expires (so that a tick
+  // only touches the entries that do)
+  uint64_t now_ms_ {};
+  TimerWheel<AddressNumber> arp_cache_timers_ {};
+  TimerWheel<AddressNumber> arp_request_timers_ {};
 };
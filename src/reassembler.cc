@@ -1,156 +1,145 @@
 #include "reassembler.hh"
 
+#include <algorithm>
+#include <span>
+
 using namespace std;
 
 Reassembler::Reassembler( ByteStream&& output )
-  : output_( std::move( output ) ), next_index_( 0 ), eof_( false ), eof_index_( 0 ), unassembled_()
+  : output_( std::move( output ) )
+  , capacity_( output_.writer().available_capacity() + output_.reader().bytes_buffered() )
 {}
 
-void Reassembler::insert(uint64_t first_index, string data, bool is_last_substring)
+void Reassembler::insert( uint64_t first_index, string data, bool is_last_substring )
 {
-    // handling the empty string case
-    if (data.empty()) {
-        if (is_last_substring) {
-            eof_ = true;
-            eof_index_ = first_index;
-            
-            // handling the empty string case
-            if (next_index_ == eof_index_) {
-                output_.writer().close();
-            }
-        }
-        return;
-    }
-    
-    // updating EOF information
-    if (is_last_substring) {
-        eof_ = true;
-        eof_index_ = first_index + data.size();
+  // updating EOF information
+  if ( is_last_substring ) {
+    eof_ = true;
+    eof_index_ = first_index + data.size();
+
+    // nothing past the end of the stream will ever be written
+    erase_pending( pending_.lower_bound( eof_index_ ), pending_.end() );
+    if ( not pending_.empty() ) {
+      uint64_t& last_end = prev( pending_.end() )->second.end;
+      bytes_pending_ -= last_end - min( last_end, eof_index_ );
+      last_end = min( last_end, eof_index_ );
     }
-    
-    // discard substrings that are completely within the scope of what has been processed
-    if (first_index + data.size() <= next_index_) {
-        // check if the substring is the last one, if so, close the stream
-        if (eof_ && next_index_ == eof_index_) {
-            output_.writer().close();
-        }
-        return;
+  }
+
+  // only bytes inside the window [next_index_, next_index_ + available capacity) can be used,
+  // and none past the end of the stream
+  uint64_t window_end = next_index_ + output_.writer().available_capacity();
+  if ( eof_ ) {
+    window_end = min( window_end, eof_index_ );
+  }
+  if ( first_index < window_end ) {
+    const uint64_t begin = max( first_index, next_index_ );
+    const uint64_t end = first_index + min( static_cast<uint64_t>( data.size() ), window_end - first_index );
+
+    if ( begin < end and begin == next_index_ ) {
+      // in order: trim in place and hand the string itself to the output stream,
+      // then write out any pending bytes that it made contiguous
+      data.resize( end - first_index );
+      data.erase( 0, begin - first_index );
+      next_index_ = end;
+      output_.writer().push( move( data ) );
+      flush();
+    } else if ( begin < end ) {
+      // out of order: keep the bytes until the gap before them is filled
+      store( begin, string_view( data ).substr( begin - first_index, end - begin ) );
     }
-    
-    // calculate ByteStream available capacity
-    uint64_t available_capacity = output_.writer().available_capacity();
-    
-    // calculate the end position of this substring within the acceptable range
-    uint64_t acceptable_end = next_index_ + available_capacity;
-    
-    // if the starting position of the substring exceeds the acceptable range, discard
-    if (first_index >= acceptable_end) {
+  }
+
+  // check if all data has been processed
+  if ( eof_ and next_index_ == eof_index_ ) {
+    output_.writer().close();
+  }
+}
+
+void Reassembler::store( uint64_t first_index, string_view data )
+{
+  // The ring only needs to exist once something arrives out of order.
+  if ( buffer_.empty() ) {
+    buffer_.resize( capacity_ );
+  }
+
+  // Every index in the window maps to a distinct slot (the window is never larger than the ring).
+  const uint64_t offset = first_index % capacity_;
+  const uint64_t first_part = min( static_cast<uint64_t>( data.size() ), capacity_ - offset );
+  data.copy( buffer_.data() + offset, first_part, 0 );
+  data.copy( buffer_.data(), data.size() - first_part, first_part );
+
+  // merge the new range with any ranges it overlaps or touches
+  uint64_t begin = first_index;
+  uint64_t end = first_index + data.size();
+  auto it = pending_.upper_bound( begin );
+  if ( it != pending_.begin() and prev( it )->second.end >= begin ) {
+    --it;
+    begin = it->first;
+    end = max( end, it->second.end );
+  }
+  auto last = it;
+  while ( last != pending_.end() and last->first <= end ) {
+    end = max( end, last->second.end );
+    ++last;
+  }
+  erase_pending( it, last );
+  pending_.emplace( begin, Range { end, ++inserts_ } );
+  bytes_pending_ += end - begin;
+}
+
+void Reassembler::erase_pending( map<uint64_t, Range>::iterator first, map<uint64_t, Range>::iterator last )
+{
+  for ( auto it = first; it != last; ++it ) {
+    bytes_pending_ -= it->second.end - it->first;
+  }
+  pending_.erase( first, last );
+}
+
+void Reassembler::flush()
+{
+  while ( not pending_.empty() and pending_.begin()->first <= next_index_ ) {
+    const uint64_t end = pending_.begin()->second.end;
+    erase_pending( pending_.begin(), next( pending_.begin() ) );
+
+    // copy the newly contiguous bytes from the ring straight into the output stream's storage
+    while ( next_index_ < end ) {
+      const uint64_t offset = next_index_ % capacity_;
+      const span<char> space = output_.writer().reserve( min( end - next_index_, capacity_ - offset ) );
+      if ( space.empty() ) {
+        // (the output is closed, so nothing pending can be written)
+        erase_pending( pending_.begin(), pending_.end() );
         return;
+      }
+      copy_n( buffer_.data() + offset, space.size(), space.data() );
+      output_.writer().commit( space.size() );
+      next_index_ += space.size();
     }
-    
-    // extract the portion within the acceptable range from the substring
-    uint64_t actual_start = max(first_index, next_index_);
-    uint64_t actual_end = min(first_index + data.size(), acceptable_end);
-    
-    // offset and length of the valid part in the substring
-    uint64_t offset = actual_start - first_index;
-    uint64_t length = actual_end - actual_start;
-    
-    // extract the available portion
-    string usable_data = data.substr(offset, length);
-    uint64_t usable_index = actual_start;
-    
-    // if it can be written directly to the output stream
-    if (usable_index == next_index_) {
-        output_.writer().push(usable_data);
-        next_index_ += usable_data.size();
-        
-        // check if there are more substrings that can be written.
-        while (!unassembled_.empty()) {
-            auto it = unassembled_.begin();
-            if (it->first > next_index_) {
-                break; // there are holes, cannot continue writing.
-            }
-            
-            // calculate how many new bytes are in this substring.
-            uint64_t overlap = next_index_ - it->first;
-            if (overlap < it->second.size()) {
-                string new_data = it->second.substr(overlap);
-                output_.writer().push(new_data);
-                next_index_ += new_data.size();
-            }
-            
-            // remove the processed substring
-            unassembled_.erase(it);
-        }
-    } else if (usable_data.size() > 0) {
-        // add substring to the unassembled map 
-        // first check for overlapping substrings, which may need to be merged
-        auto it = unassembled_.lower_bound(usable_index);
-        
-        // check the preceding substring
-        if (it != unassembled_.begin()) {
-            auto prev_it = prev(it);
-            uint64_t prev_end = prev_it->first + prev_it->second.size();
-            
-            // if the preceding substring overlaps or is adjacent to the current substring
-            if (prev_end >= usable_index) {
-                // extend the preceding substring
-                if (prev_end < usable_index + usable_data.size()) {
-                    uint64_t extend_len = usable_data.size() - (prev_end - usable_index);
-                    prev_it->second += usable_data.substr(usable_data.size() - extend_len);
-                }
-                
-                // if completely covered by the preceding substring, there is no need to store
-                if (prev_end >= usable_index + usable_data.size()) {
-                    // check if completed
-                    if (eof_ && next_index_ == eof_index_) {
-                        output_.writer().close();
-                    }
-                    return;
-                }
-                
-                // update the pending substring information
-                usable_index = prev_it->first;
-                usable_data = prev_it->second;
-                unassembled_.erase(prev_it);
-            }
-        }
-        
-        // check and merge the following substring
-        while (it != unassembled_.end() && it->first <= usable_index + usable_data.size()) {
-            uint64_t it_end = it->first + it->second.size();
-            
-            // if the following substring extends beyond the current substring, merge it
-            if (it_end > usable_index + usable_data.size()) {
-                uint64_t extend_len = it_end - (usable_index + usable_data.size());
-                usable_data += it->second.substr(it->second.size() - extend_len);
-            }
-            
-            auto to_erase = it;
-            ++it;
-            unassembled_.erase(to_erase);
-        }
-        
-        // store the merged substring
-        unassembled_[usable_index] = usable_data;
-    }
-    
-    // check if all data has been processed
-    if (eof_ && next_index_ == eof_index_) {
-        output_.writer().close();
-    }
+  }
 }
 
 uint64_t Reassembler::count_bytes_pending() const
 {
-    uint64_t total = 0;
-    for (const auto& [index, data] : unassembled_) {
-        // only calculate the unprocessed bytes
-        if (index + data.size() > next_index_) {
-            uint64_t valid_start = max(index, next_index_);
-            total += (index + data.size()) - valid_start;
-        }
-    }
-    return total;
-}
\ No newline at end of file
+  return bytes_pending_;
+}
+
+vector<pair<uint64_t, uint64_t>> Reassembler::pending_ranges( size_t max_ranges ) const
+{
+  vector<pair<uint64_t, const Range*>> ranges;
+  ranges.reserve( pending_.size() );
+  for ( const auto& [begin, range] : pending_ ) {
+    ranges.emplace_back( begin, &range );
+  }
+
+  // newest first
+  const size_t count = min( max_ranges, ranges.size() );
+  const auto newer = []( const auto& a, const auto& b ) { return a.second->updated > b.second->updated; };
+  partial_sort( ranges.begin(), ranges.begin() + static_cast<ptrdiff_t>( count ), ranges.end(), newer );
+
+  vector<pair<uint64_t, uint64_t>> result;
+  result.reserve( count );
+  for ( size_t i = 0; i < count; ++i ) {
+    result.emplace_back( ranges[i].first, ranges[i].second->end );
+  }
+  return result;
+}
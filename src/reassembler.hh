@@ -1,7 +1,10 @@
 #pragma once
 
 #include "byte_stream.hh"
+
 #include <map>
+#include <utility>
+#include <vector>
 
 class Reassembler
 {
@@ -31,9 +34,12 @@ public:
   void insert( uint64_t first_index, std::string data, bool is_last_substring );
 
   // How many bytes are stored in the Reassembler itself?
-  // This function is for testing only; don't add extra state to support it.
   uint64_t count_bytes_pending() const;
 
+  // The [begin, end) index ranges of the bytes held in the Reassembler (the "islands" after each hole),
+  // at most `max_ranges` of them, most recently extended first (the order RFC 2018 wants SACK blocks in).
+  std::vector<std::pair<uint64_t, uint64_t>> pending_ranges( size_t max_ranges ) const;
+
   // Access output stream reader
   Reader& reader() { return output_.reader(); }
   const Reader& reader() const { return output_.reader(); }
@@ -43,8 +49,22 @@ public:
 
 private:
   ByteStream output_;
-  uint64_t next_index_ = 0;                     // Index of the next byte to write
-  bool eof_ = false;                            // Whether we've seen the last substring
-  uint64_t eof_index_ = 0;                      // Index after the last byte in the stream
-  std::map<uint64_t, std::string> unassembled_; // Unassembled substrings
-};
\ No newline at end of file
+  uint64_t capacity_;                       // Capacity of the output stream (and size of buffer_)
+  uint64_t next_index_ = 0;                 // Index of the next byte to write
+  bool eof_ = false;                        // Whether we've seen the last substring
+  uint64_t eof_index_ = 0;                  // Index after the last byte in the stream
+  std::string buffer_ {}; // Ring holding pending bytes: stream index i lives at i % capacity_
+
+  struct Range
+  {
+    uint64_t end;     // One past the range's last index
+    uint64_t updated; // Value of inserts_ when the range last grew
+  };
+  std::map<uint64_t, Range> pending_ {}; // Disjoint, non-adjacent ranges of bytes in buffer_, keyed by begin
+  uint64_t inserts_ {};                  // Number of out-of-order inserts so far
+  uint64_t bytes_pending_ {};            // Total size of the ranges in pending_
+
+  void store( uint64_t first_index, std::string_view data ); // Copy bytes into buffer_ and record their range
+  void flush();                                              // Write now-contiguous pending bytes to the output
+  void erase_pending( std::map<uint64_t, Range>::iterator first, std::map<uint64_t, Range>::iterator last );
+};
@@ -0,0 +1,30 @@
+#include "rtt_estimator.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+RTTEstimator::RTTEstimator( uint64_t initial_RTO_ms, uint64_t min_RTO_ms, uint64_t max_RTO_ms )
+  : min_RTO_ms_( min_RTO_ms ), max_RTO_ms_( max_RTO_ms ), rto_ms_( initial_RTO_ms )
+{}
+
+void RTTEstimator::sample( uint64_t rtt_us )
+{
+  const double rtt = static_cast<double>( rtt_us );
+
+  if ( not has_sample_ ) {
+    // (2.2) first measurement
+    has_sample_ = true;
+    srtt_us_ = rtt;
+    rttvar_us_ = rtt / 2;
+  } else {
+    // (2.3) later measurements (RTTVAR is updated with the old SRTT)
+    rttvar_us_ = ( 1 - BETA ) * rttvar_us_ + BETA * abs( srtt_us_ - rtt );
+    srtt_us_ = ( 1 - ALPHA ) * srtt_us_ + ALPHA * rtt;
+  }
+
+  // (2.4) and (2.5), rounded up to the millisecond that the retransmission timer counts in
+  const double rto_us = srtt_us_ + max( CLOCK_GRANULARITY_US, K * rttvar_us_ );
+  rto_ms_ = clamp( static_cast<uint64_t>( ceil( rto_us / 1000 ) ), min_RTO_ms_, max_RTO_ms_ );
+}
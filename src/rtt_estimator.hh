@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * The RTTEstimator keeps the smoothed round-trip time (SRTT) and its variation (RTTVAR) from the RTT
+ * samples the TCPSender takes, and computes the retransmission timeout from them (RFC 6298 section 2).
+ *
+ * Only segments that were never retransmitted are timed (Karn's rule); that is up to the sender.
+ */
+class RTTEstimator
+{
+public:
+  // RTO before the first sample, and the clamps on the computed RTO, in milliseconds
+  RTTEstimator( uint64_t initial_RTO_ms, uint64_t min_RTO_ms, uint64_t max_RTO_ms );
+
+  void sample( uint64_t rtt_us ); // Take a new round-trip measurement, in microseconds
+
+  bool has_sample() const { return has_sample_; }
+  double srtt_us() const { return srtt_us_; }            // Smoothed round-trip time (0 before the first sample)
+  double rttvar_us() const { return rttvar_us_; }        // Round-trip time variation (0 before the first sample)
+  double srtt_ms() const { return srtt_us_ / 1000; }     // The same, in milliseconds
+  double rttvar_ms() const { return rttvar_us_ / 1000; } // The same, in milliseconds
+  uint64_t rto_ms() const { return rto_ms_; }            // Retransmission timeout (before any backoff)
+
+private:
+  static constexpr double ALPHA = 1.0 / 8;
+  static constexpr double BETA = 1.0 / 4;
+  static constexpr double K = 4;
+  // RTT samples come from the sender's microsecond clock (those taken from the timestamps option are coarser,
+  // whole milliseconds, but RTTVAR reflects that)
+  static constexpr double CLOCK_GRANULARITY_US = 1;
+
+  uint64_t min_RTO_ms_;
+  uint64_t max_RTO_ms_;
+  bool has_sample_ {};
+  double srtt_us_ {};
+  double rttvar_us_ {};
+  uint64_t rto_ms_;
+};
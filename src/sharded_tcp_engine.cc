@@ -0,0 +1,238 @@
+#include "sharded_tcp_engine.hh"
+
+#include "exception.hh"
+#include "ipv4_header.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <optional>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/eventfd.h>
+#include <utility>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+// The connection that an incoming datagram belongs to (from our side), read from the IP header and the first
+// four bytes of the TCP header, without parsing the segment
+optional<FourTuple> tuple_of( const InternetDatagram& dgram )
+{
+  if ( dgram.header.proto != IPv4Header::PROTO_TCP ) {
+    return {};
+  }
+
+  uint32_t ports = 0;
+  size_t bytes = 0;
+  for ( const auto& buffer : dgram.payload ) {
+    for ( const char ch : string_view { buffer } ) {
+      if ( bytes == sizeof( ports ) ) {
+        break;
+      }
+      ports = ports << 8 | static_cast<uint8_t>( ch );
+      bytes++;
+    }
+  }
+  if ( bytes < sizeof( ports ) ) {
+    return {};
+  }
+
+  return FourTuple { .local_address = dgram.header.dst,
+                     .local_port = static_cast<uint16_t>( ports ),
+                     .remote_address = dgram.header.src,
+                     .remote_port = static_cast<uint16_t>( ports >> 16 ) };
+}
+
+uint64_t now_ms()
+{
+  return duration_cast<milliseconds>( steady_clock::now().time_since_epoch() ).count();
+}
+
+} // namespace
+
+ShardedTCPEngine::Shard::Shard( const TCPConfig& config, size_t index, size_t shards )
+  : engine_( config )
+  , index_( index )
+  , shards_( shards )
+  , wakeup_( CheckSystemCall( "eventfd", ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) )
+{}
+
+FourTuple ShardedTCPEngine::Shard::connect( const Address& local, const Address& remote )
+{
+  // About one port in every `shards_` hashes to this shard
+  for ( size_t tries = 0; tries <= UINT16_MAX; tries++ ) {
+    const uint16_t port = next_port_;
+    next_port_ = next_port_ == UINT16_MAX ? 49152 : next_port_ + 1;
+
+    const FourTuple tuple { local.ipv4_numeric(), port, remote.ipv4_numeric(), remote.port() };
+    if ( shard_of( tuple, shards_ ) == index_ and not engine_.find( tuple ) ) {
+      return engine_.connect( Address { local.ip(), port }, remote );
+    }
+  }
+  throw runtime_error( "shard " + to_string( index_ ) + " has no free local port for " + remote.to_string() );
+}
+
+void ShardedTCPEngine::Shard::run( const atomic<bool>& running, const Application& application )
+{
+  uint64_t last_tick_ms = now_ms();
+  while ( running.load( memory_order_relaxed ) ) {
+    bool idle = true;
+
+    while ( auto dgram = inbound_.pop() ) {
+      engine_.receive( move( *dgram ) );
+      idle = false;
+    }
+
+    const uint64_t now = now_ms();
+    if ( now > last_tick_ms ) {
+      engine_.tick( now - last_tick_ms );
+      last_tick_ms = now;
+    }
+
+    application( *this );
+
+    // (What doesn't fit in the queue waits in the engine for the next round)
+    auto& datagrams = engine_.datagrams_out();
+    while ( not datagrams.empty() and outbound_.push( datagrams.front() ) ) {
+      datagrams.pop();
+      idle = false;
+    }
+
+    if ( not datagrams.empty() ) {
+      this_thread::yield(); // (until the I/O thread makes room in the outbound queue)
+    } else if ( idle ) {
+      sleep( running );
+    }
+  }
+}
+
+void ShardedTCPEngine::Shard::sleep( const atomic<bool>& running )
+{
+  // The fence pairs with the one in notify(): either we see the datagram it queued, or it sees that we are
+  // going to sleep and wakes us
+  sleeping_.store( true, memory_order_relaxed );
+  atomic_thread_fence( memory_order_seq_cst );
+  if ( inbound_.empty() and running.load( memory_order_relaxed ) ) {
+    const optional<uint64_t> timer_ms = engine_.ms_until_timer();
+    const int timeout_ms = timer_ms.has_value() ? static_cast<int>( min<uint64_t>( *timer_ms, INT_MAX ) ) : -1;
+    pollfd pfd { wakeup_.fd_num(), POLLIN, 0 };
+    CheckSystemCall( "poll", ::poll( &pfd, 1, timeout_ms ) );
+  }
+  sleeping_.store( false, memory_order_relaxed );
+
+  uint64_t count {};
+  wakeup_.read( span { reinterpret_cast<char*>( &count ), sizeof( count ) } ); // NOLINT(*-reinterpret-cast)
+}
+
+void ShardedTCPEngine::Shard::notify()
+{
+  atomic_thread_fence( memory_order_seq_cst );
+  if ( sleeping_.load( memory_order_relaxed ) ) {
+    wake();
+  }
+}
+
+void ShardedTCPEngine::Shard::wake()
+{
+  const uint64_t one = 1;
+  wakeup_.write( { reinterpret_cast<const char*>( &one ), sizeof( one ) } ); // NOLINT(*-reinterpret-cast)
+}
+
+ShardedTCPEngine::ShardedTCPEngine( const TCPConfig& config, size_t shards, Application application )
+  : application_( move( application ) )
+{
+  if ( shards == 0 ) {
+    throw runtime_error( "ShardedTCPEngine needs at least one shard" );
+  }
+  for ( size_t i = 0; i < shards; i++ ) {
+    shards_.push_back( make_unique<Shard>( config, i, shards ) );
+  }
+}
+
+void ShardedTCPEngine::listen( uint16_t port, size_t backlog, size_t syn_queue_length )
+{
+  if ( running_ ) {
+    throw runtime_error( "ShardedTCPEngine::listen() after start()" );
+  }
+  for ( const auto& shard : shards_ ) {
+    shard->engine_.listen( port, backlog, syn_queue_length );
+  }
+}
+
+void ShardedTCPEngine::pin_to_cores( size_t first_core )
+{
+  if ( running_ ) {
+    throw runtime_error( "ShardedTCPEngine::pin_to_cores() after start()" );
+  }
+  first_core_ = first_core;
+}
+
+void ShardedTCPEngine::start()
+{
+  if ( running_.exchange( true ) ) {
+    return;
+  }
+  const size_t cores = max( thread::hardware_concurrency(), 1U );
+  for ( const auto& shard : shards_ ) {
+    auto& worker = workers_.emplace_back( &Shard::run, shard.get(), cref( running_ ), cref( application_ ) );
+    if ( first_core_.has_value() ) {
+      cpu_set_t cpus;
+      CPU_ZERO( &cpus );
+      CPU_SET( ( *first_core_ + shard->index() ) % cores, &cpus );
+      if ( const int err = pthread_setaffinity_np( worker.native_handle(), sizeof( cpus ), &cpus ) ) {
+        throw unix_error( "pthread_setaffinity_np", err );
+      }
+    }
+  }
+}
+
+void ShardedTCPEngine::stop()
+{
+  running_ = false;
+  for ( const auto& shard : shards_ ) {
+    shard->wake();
+  }
+  for ( auto& worker : workers_ ) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+ShardedTCPEngine::~ShardedTCPEngine()
+{
+  stop();
+}
+
+bool ShardedTCPEngine::receive( InternetDatagram dgram )
+{
+  const optional<FourTuple> tuple = tuple_of( dgram );
+  if ( not tuple.has_value() ) {
+    return false;
+  }
+  Shard& shard = *shards_[shard_of( *tuple, shards_.size() )];
+  if ( not shard.inbound_.push( dgram ) ) {
+    return false;
+  }
+  shard.notify();
+  return true;
+}
+
+size_t ShardedTCPEngine::collect( const function<void( InternetDatagram& )>& output )
+{
+  size_t count = 0;
+  for ( const auto& shard : shards_ ) {
+    while ( auto dgram = shard->outbound_.pop() ) {
+      output( *dgram );
+      count++;
+    }
+  }
+  return count;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "address.hh"
+#include "file_descriptor.hh"
+#include "four_tuple.hh"
+#include "ipv4_datagram.hh"
+#include "spsc_queue.hh"
+#include "tcp_config.hh"
+#include "tcp_engine.hh"
+#include "tcp_listener.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// \brief A TCPEngine split across worker threads, each owning a disjoint shard of the connections.
+//
+// A connection belongs to the shard that the RSS hash of its addresses and ports picks, the way a multi-queue NIC
+// steers it to one core. Each worker thread runs its own TCPEngine, so no TCPPeer is ever touched by two
+// threads. One I/O thread hands each incoming datagram to its shard through a lock-free queue (receive()), and
+// collects what the shards send from another (collect()).
+//
+// The application's work for a shard (accepting, reading and writing its connections) runs on that shard's
+// worker thread, in the Application callback. A worker with nothing to do sleeps until a datagram is handed to
+// its shard or its engine's next timer is due.
+class ShardedTCPEngine
+{
+public:
+  class Shard;
+
+  // Called by each worker thread, on its own shard, after each round of datagrams and timers
+  using Application = std::function<void( Shard& shard )>;
+
+  static constexpr size_t QUEUE_CAPACITY = 4096; // datagrams each way between the I/O thread and a shard
+
+  ShardedTCPEngine( const TCPConfig& config, size_t shards, Application application );
+
+  // Accept connections to `port` on every shard (before start())
+  void listen( uint16_t port,
+               size_t backlog = TCPListener::DEFAULT_BACKLOG,
+               size_t syn_queue_length = TCPListener::DEFAULT_SYN_QUEUE_LENGTH );
+
+  // Run each worker thread on a core of its own, the way a NIC's receive queue i interrupts core i: shard i runs on
+  // core (first_core + i), counting modulo the number of cores (before start())
+  void pin_to_cores( size_t first_core );
+
+  // Start and stop the worker threads
+  void start();
+  void stop();
+
+  // I/O thread: hand a datagram from the network to the shard that owns its connection (false if that shard's
+  // queue was full and the datagram was dropped, like a NIC's receive ring overflowing)
+  bool receive( InternetDatagram dgram );
+
+  // I/O thread: pass each datagram that the shards have sent to `output`, and return how many there were
+  size_t collect( const std::function<void( InternetDatagram& )>& output );
+
+  // The shard that owns a connection
+  static size_t shard_of( const FourTuple& tuple, size_t shards ) { return tuple.rss_hash() % shards; }
+
+  size_t shards() const { return shards_.size(); }
+
+  ~ShardedTCPEngine();
+
+  ShardedTCPEngine( const ShardedTCPEngine& other ) = delete;
+  ShardedTCPEngine& operator=( const ShardedTCPEngine& other ) = delete;
+  ShardedTCPEngine( ShardedTCPEngine&& other ) = delete;
+  ShardedTCPEngine& operator=( ShardedTCPEngine&& other ) = delete;
+
+private:
+  std::vector<std::unique_ptr<Shard>> shards_ {};
+  Application application_;
+  std::optional<size_t> first_core_ {}; // where pin_to_cores() put shard 0, if it was called
+  std::atomic<bool> running_ {};
+  std::vector<std::thread> workers_ {};
+};
+
+// One worker's part of a ShardedTCPEngine: its TCPEngine, and its queues to and from the I/O thread
+class ShardedTCPEngine::Shard
+{
+public:
+  Shard( const TCPConfig& config, size_t index, size_t shards );
+
+  // This shard's connections (only to be used from its worker thread)
+  TCPEngine& engine() { return engine_; }
+
+  // Open a connection from `local` (an address, whose port is ignored) to `remote`. The local port is chosen so
+  // that the connection's replies are steered back to this shard.
+  FourTuple connect( const Address& local, const Address& remote );
+
+  size_t index() const { return index_; }
+
+private:
+  friend class ShardedTCPEngine;
+
+  TCPEngine engine_;
+  size_t index_;
+  size_t shards_;
+  uint16_t next_port_ { 49152 }; // next ephemeral port to try (RFC 6335's dynamic range)
+
+  SPSCQueue<InternetDatagram> inbound_ { QUEUE_CAPACITY };  // from the I/O thread
+  SPSCQueue<InternetDatagram> outbound_ { QUEUE_CAPACITY }; // to the I/O thread
+
+  FileDescriptor wakeup_;         // eventfd that wakes the worker from sleep()
+  std::atomic<bool> sleeping_ {}; // is the worker (about to be) asleep?
+
+  // The worker thread's loop: take in datagrams, let time pass, run the application, and send
+  void run( const std::atomic<bool>& running, const Application& application );
+
+  // Worker thread: wait until a datagram arrives, the engine's next timer is due, or wake() is called
+  void sleep( const std::atomic<bool>& running );
+
+  // I/O thread: wake the worker, after queueing a datagram for it (if it may have gone to sleep) or to stop it
+  void notify();
+  void wake();
+};
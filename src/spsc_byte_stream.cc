@@ -0,0 +1,190 @@
+#include "spsc_byte_stream.hh"
+
+#include "exception.hh"
+
+#include <algorithm>
+#include <bit>
+#include <span>
+#include <sys/eventfd.h>
+
+using namespace std;
+
+SPSCByteStream::SPSCByteStream( uint64_t capacity )
+  : capacity_( capacity )
+  , mask_( bit_ceil( max( capacity, uint64_t { 1 } ) ) - 1 )
+  , ring_( make_unique<char[]>( mask_ + 1 ) ) // NOLINT(*-avoid-c-arrays)
+{}
+
+void SPSCByteStream::enable_wakeups()
+{
+  data_event_.emplace( CheckSystemCall( "eventfd", ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) );
+  space_event_.emplace( CheckSystemCall( "eventfd", ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) );
+}
+
+void SPSCByteStream::signal( optional<FileDescriptor>& event )
+{
+  if ( event.has_value() ) {
+    const uint64_t one = 1;
+    event->write( { reinterpret_cast<const char*>( &one ), sizeof( one ) } ); // NOLINT(*-reinterpret-cast)
+  }
+}
+
+void SPSCByteStream::clear( optional<FileDescriptor>& event )
+{
+  if ( event.has_value() ) {
+    uint64_t count {};
+    event->read( span { reinterpret_cast<char*>( &count ), sizeof( count ) } ); // NOLINT(*-reinterpret-cast)
+  }
+}
+
+void SPSCByteStream::set_error()
+{
+  error_.store( true, memory_order_release );
+  signal( data_event_ );
+  signal( space_event_ );
+}
+
+bool SPSCByteStream::has_error() const
+{
+  return error_.load( memory_order_acquire );
+}
+
+void SPSCByteStream::Writer::push( string_view data )
+{
+  if ( is_closed() or has_error() ) {
+    return;
+  }
+
+  // Only the writer advances bytes_pushed_; the acquire on bytes_popped_ makes sure the reader is done
+  // with the space we are about to overwrite.
+  const uint64_t pushed = bytes_pushed_.load( memory_order_relaxed );
+  const uint64_t popped = bytes_popped_.load( memory_order_acquire );
+  const uint64_t len = min( capacity_ - ( pushed - popped ), static_cast<uint64_t>( data.size() ) );
+  if ( len == 0 ) {
+    return;
+  }
+
+  const uint64_t offset = pushed & mask_;
+  const uint64_t first_part = min( len, mask_ + 1 - offset );
+  data.copy( ring_.get() + offset, first_part, 0 );
+  data.copy( ring_.get(), len - first_part, first_part );
+
+  bytes_pushed_.store( pushed + len, memory_order_release );
+
+  // Wake the reader if it could have seen the stream empty and gone to sleep. The fence pairs with the one
+  // in pop(): either the reader sees our new bytes_pushed_, or we see that it had caught up with us.
+  if ( data_event_.has_value() ) {
+    atomic_thread_fence( memory_order_seq_cst );
+    if ( bytes_popped_.load( memory_order_relaxed ) == pushed ) {
+      signal( data_event_ );
+    }
+  }
+}
+
+void SPSCByteStream::Writer::close()
+{
+  closed_.store( true, memory_order_release );
+  signal( data_event_ );
+}
+
+bool SPSCByteStream::Writer::is_closed() const
+{
+  return closed_.load( memory_order_relaxed );
+}
+
+uint64_t SPSCByteStream::Writer::available_capacity() const
+{
+  return capacity_ - ( bytes_pushed_.load( memory_order_relaxed ) - bytes_popped_.load( memory_order_acquire ) );
+}
+
+uint64_t SPSCByteStream::Writer::bytes_pushed() const
+{
+  return bytes_pushed_.load( memory_order_relaxed );
+}
+
+FileDescriptor& SPSCByteStream::Writer::wakeup_fd()
+{
+  return space_event_.value();
+}
+
+void SPSCByteStream::Writer::clear_wakeup()
+{
+  clear( space_event_ );
+}
+
+string_view SPSCByteStream::Reader::peek() const
+{
+  const uint64_t popped = bytes_popped_.load( memory_order_relaxed );
+  const uint64_t pushed = bytes_pushed_.load( memory_order_acquire );
+  const uint64_t offset = popped & mask_;
+  return { ring_.get() + offset, min( pushed - popped, mask_ + 1 - offset ) };
+}
+
+void SPSCByteStream::Reader::pop( uint64_t len )
+{
+  const uint64_t popped = bytes_popped_.load( memory_order_relaxed );
+  const uint64_t pushed = bytes_pushed_.load( memory_order_acquire );
+  len = min( len, pushed - popped );
+
+  bytes_popped_.store( popped + len, memory_order_release );
+
+  // Wake the writer if it could have seen the stream full and gone to sleep (see push()).
+  if ( space_event_.has_value() ) {
+    atomic_thread_fence( memory_order_seq_cst );
+    if ( len > 0 and bytes_pushed_.load( memory_order_relaxed ) - popped == capacity_ ) {
+      signal( space_event_ );
+    }
+  }
+}
+
+bool SPSCByteStream::Reader::is_finished() const
+{
+  // Once the reader sees closed_, every byte pushed before close() is visible too.
+  return closed_.load( memory_order_acquire ) and bytes_buffered() == 0;
+}
+
+uint64_t SPSCByteStream::Reader::bytes_buffered() const
+{
+  return bytes_pushed_.load( memory_order_acquire ) - bytes_popped_.load( memory_order_relaxed );
+}
+
+uint64_t SPSCByteStream::Reader::bytes_popped() const
+{
+  return bytes_popped_.load( memory_order_relaxed );
+}
+
+FileDescriptor& SPSCByteStream::Reader::wakeup_fd()
+{
+  return data_event_.value();
+}
+
+void SPSCByteStream::Reader::clear_wakeup()
+{
+  clear( data_event_ );
+}
+
+SPSCByteStream::Reader& SPSCByteStream::reader()
+{
+  static_assert( sizeof( Reader ) == sizeof( SPSCByteStream ),
+                 "Please add member variables to the SPSCByteStream base, not the SPSCByteStream Reader." );
+
+  return static_cast<Reader&>( *this ); // NOLINT(*-downcast)
+}
+
+const SPSCByteStream::Reader& SPSCByteStream::reader() const
+{
+  return static_cast<const Reader&>( *this ); // NOLINT(*-downcast)
+}
+
+SPSCByteStream::Writer& SPSCByteStream::writer()
+{
+  static_assert( sizeof( Writer ) == sizeof( SPSCByteStream ),
+                 "Please add member variables to the SPSCByteStream base, not the SPSCByteStream Writer." );
+
+  return static_cast<Writer&>( *this ); // NOLINT(*-downcast)
+}
+
+const SPSCByteStream::Writer& SPSCByteStream::writer() const
+{
+  return static_cast<const Writer&>( *this ); // NOLINT(*-downcast)
+}
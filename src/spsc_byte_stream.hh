@@ -0,0 +1,95 @@
+#pragma once
+
+#include "file_descriptor.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+/*
+ * SPSCByteStream: a ByteStream variant that two threads can use at the same time, as long as
+ * one thread owns the writer() side and the other owns the reader() side.
+ *
+ * The bytes live in a fixed-size ring indexed by two atomic counters (bytes pushed and bytes popped),
+ * each advanced by only one side, so neither side ever takes a lock or makes a system call.
+ *
+ * Optionally (enable_wakeups()), each side gets an eventfd that becomes readable when the other side makes
+ * progress, so a thread can sleep in poll(2) (e.g. inside an EventLoop) instead of spinning. To avoid a
+ * system call per operation, the events are edge-triggered: the reader's event fires when a push makes an
+ * empty stream non-empty (or on close/error), and the writer's event fires when a pop frees space in a full
+ * stream. So a side should only go to sleep after it has seen the stream empty (or full).
+ */
+class SPSCByteStream
+{
+public:
+  class Reader;
+  class Writer;
+
+  explicit SPSCByteStream( uint64_t capacity );
+
+  // Create the wakeup eventfds. Call before handing the stream's sides to their threads.
+  void enable_wakeups();
+
+  Reader& reader();
+  const Reader& reader() const;
+  Writer& writer();
+  const Writer& writer() const;
+
+  void set_error();       // Signal that the stream suffered an error (either side may call this).
+  bool has_error() const; // Has the stream had an error?
+
+  // The stream is shared by two threads by reference, so it cannot be copied or moved.
+  SPSCByteStream( const SPSCByteStream& other ) = delete;
+  SPSCByteStream& operator=( const SPSCByteStream& other ) = delete;
+  SPSCByteStream( SPSCByteStream&& other ) = delete;
+  SPSCByteStream& operator=( SPSCByteStream&& other ) = delete;
+  ~SPSCByteStream() = default;
+
+protected:
+  // Please add any additional state to the SPSCByteStream here, and not to the Writer and Reader interfaces.
+  uint64_t capacity_;
+  uint64_t mask_;                // The ring's size is a power of two, so (index & mask_) is the offset
+  std::unique_ptr<char[]> ring_; // mask_ + 1 bytes
+
+  // Each counter is advanced by only one side, and lives on its own cache line.
+  alignas( 64 ) std::atomic<uint64_t> bytes_pushed_ {}; // advanced by the writer
+  alignas( 64 ) std::atomic<uint64_t> bytes_popped_ {}; // advanced by the reader
+  alignas( 64 ) std::atomic<bool> closed_ {};
+  std::atomic<bool> error_ {};
+
+  std::optional<FileDescriptor> data_event_ {};  // Signalled for the reader: new bytes, close or error
+  std::optional<FileDescriptor> space_event_ {}; // Signalled for the writer: new space or error
+
+  static void signal( std::optional<FileDescriptor>& event );
+  static void clear( std::optional<FileDescriptor>& event );
+};
+
+class SPSCByteStream::Writer : public SPSCByteStream
+{
+public:
+  void push( std::string_view data ); // Push data to stream, but only as much as available capacity allows.
+  void close();                       // Signal that the stream has reached its ending.
+
+  bool is_closed() const;              // Has the stream been closed?
+  uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
+  uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
+
+  FileDescriptor& wakeup_fd(); // Readable after the reader frees space in a full stream (needs enable_wakeups())
+  void clear_wakeup();         // Reset wakeup_fd() before waiting on it again
+};
+
+class SPSCByteStream::Reader : public SPSCByteStream
+{
+public:
+  std::string_view peek() const; // Peek at the next bytes in the buffer (up to the ring's wrap point)
+  void pop( uint64_t len );      // Remove `len` bytes from the buffer
+
+  bool is_finished() const;        // Is the stream finished (closed and fully popped)?
+  uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
+  uint64_t bytes_popped() const;   // Total number of bytes cumulatively popped from stream
+
+  FileDescriptor& wakeup_fd(); // Readable after a push into an empty stream (needs enable_wakeups())
+  void clear_wakeup();         // Reset wakeup_fd() before waiting on it again
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/*
+ * SPSCQueue: a bounded queue of objects that two threads can use at the same time, as long as one
+ * thread only pushes and the other only pops.
+ *
+ * Like SPSCByteStream, the items live in a fixed-size ring indexed by two atomic counters (items pushed
+ * and items popped), each advanced by only one side, so neither side ever takes a lock.
+ */
+template<class T>
+class SPSCQueue
+{
+public:
+  explicit SPSCQueue( size_t capacity )
+    : mask_( std::bit_ceil( std::max( capacity, size_t { 1 } ) ) - 1 ), slots_( mask_ + 1 )
+  {}
+
+  // Add an item to the back of the queue (returns false, leaving `item` alone, if the queue is full)
+  bool push( T& item )
+  {
+    // The acquire on popped_ makes sure the reader is done with the slot we are about to overwrite
+    const uint64_t pushed = pushed_.load( std::memory_order_relaxed );
+    if ( pushed - popped_.load( std::memory_order_acquire ) > mask_ ) {
+      return false;
+    }
+    slots_[pushed & mask_] = std::move( item );
+    pushed_.store( pushed + 1, std::memory_order_release );
+    return true;
+  }
+
+  // Take the item at the front of the queue, if there is one
+  std::optional<T> pop()
+  {
+    const uint64_t popped = popped_.load( std::memory_order_relaxed );
+    if ( popped == pushed_.load( std::memory_order_acquire ) ) {
+      return {};
+    }
+    std::optional<T> item { std::move( slots_[popped & mask_] ) };
+    popped_.store( popped + 1, std::memory_order_release );
+    return item;
+  }
+
+  bool empty() const
+  {
+    return popped_.load( std::memory_order_acquire ) == pushed_.load( std::memory_order_acquire );
+  }
+
+  // The queue is shared by two threads by reference, so it cannot be copied or moved.
+  SPSCQueue( const SPSCQueue& other ) = delete;
+  SPSCQueue& operator=( const SPSCQueue& other ) = delete;
+  SPSCQueue( SPSCQueue&& other ) = delete;
+  SPSCQueue& operator=( SPSCQueue&& other ) = delete;
+  ~SPSCQueue() = default;
+
+private:
+  uint64_t mask_;        // The ring's size is a power of two, so (index & mask_) is the slot
+  std::vector<T> slots_; // mask_ + 1 items
+
+  // Each counter is advanced by only one side, and lives on its own cache line.
+  alignas( 64 ) std::atomic<uint64_t> pushed_ {}; // advanced by the writer
+  alignas( 64 ) std::atomic<uint64_t> popped_ {}; // advanced by the reader
+};
@@ -0,0 +1,228 @@
+#include "tcp_engine.hh"
+
+#include "helpers.hh"
+#include "ipv4_header.hh"
+#include "tcp_over_ip.hh"
+#include "tcp_segment.hh"
+
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+void TCPEngine::send( const FourTuple& tuple, const TCPMessage& msg )
+{
+  datagrams_out_.push( TCPOverIPv4Adapter::wrap_tcp_in_ip(
+    msg, tuple.local_address, tuple.local_port, tuple.remote_address, tuple.remote_port ) );
+}
+
+TCPEngine::Connection& TCPEngine::open( const FourTuple& tuple, const TCPConfig& config )
+{
+  // The connection's segments go out between its own addresses and ports
+  auto transmit = [this, tuple]( const TCPMessage& msg ) { send( tuple, msg ); };
+  return connections_.try_emplace( tuple, config, move( transmit ), now_ms_ ).first->second;
+}
+
+void TCPEngine::catch_up( Connection& connection )
+{
+  if ( connection.clock_ms < now_ms_ ) {
+    connection.peer.tick( now_ms_ - connection.clock_ms, connection.transmit );
+    connection.clock_ms = now_ms_;
+  }
+}
+
+void TCPEngine::rearm( const FourTuple& tuple, const TCPPeer& peer )
+{
+  // A connection that has finished is looked at on the next tick (to be forgotten)
+  if ( not peer.active() ) {
+    timers_.schedule( tuple, now_ms_ );
+    return;
+  }
+
+  // (The wheel counts whole milliseconds, so round up)
+  const optional<uint64_t> delay_us = peer.us_until_timer();
+  if ( delay_us.has_value() ) {
+    timers_.schedule( tuple, now_ms_ + max( ( *delay_us + 999 ) / 1000, uint64_t { 1 } ) );
+  } else {
+    timers_.cancel( tuple );
+  }
+}
+
+void TCPEngine::expire( const FourTuple& tuple )
+{
+  const auto it = connections_.find( tuple );
+  if ( it == connections_.end() ) {
+    return;
+  }
+  Connection& connection = it->second;
+  catch_up( connection );
+
+  // A connection is forgotten once it has finished, and the application has read everything it received
+  const Reader& inbound = connection.peer.inbound_reader();
+  if ( connection.peer.active() ) {
+    rearm( tuple, connection.peer );
+  } else if ( inbound.has_error() or not inbound.bytes_buffered() ) {
+    connections_.erase( it );
+  } else {
+    timers_.schedule( tuple, now_ms_ + FORGET_POLL_MS );
+  }
+}
+
+FourTuple TCPEngine::connect( const Address& local, const Address& remote )
+{
+  const FourTuple tuple { local.ipv4_numeric(), local.port(), remote.ipv4_numeric(), remote.port() };
+  if ( connections_.contains( tuple ) ) {
+    throw runtime_error( "connect() to " + tuple.to_string() + ", which is already connected" );
+  }
+
+  TCPConfig config = config_;
+  config.isn = Wrap32 { uniform_int_distribution<uint32_t> {}( rng_ ) };
+  Connection& connection = open( tuple, config );
+  connection.peer.push( connection.transmit );
+  rearm( tuple, connection.peer );
+  return tuple;
+}
+
+void TCPEngine::listen( uint16_t port, size_t backlog, size_t syn_queue_length )
+{
+  if ( not listeners_.try_emplace( port, config_, backlog, syn_queue_length ).second ) {
+    throw runtime_error( "listen() on port " + to_string( port ) + ", which already has a listener" );
+  }
+}
+
+optional<FourTuple> TCPEngine::accept( uint16_t port )
+{
+  const auto listener = listeners_.find( port );
+  if ( listener == listeners_.end() ) {
+    return {};
+  }
+  while ( const auto tuple = listener->second.accept() ) {
+    if ( connections_.contains( *tuple ) ) { // (it may have failed and been forgotten while it waited)
+      return tuple;
+    }
+  }
+  return {};
+}
+
+const TCPListener* TCPEngine::listener( uint16_t port ) const
+{
+  const auto it = listeners_.find( port );
+  return it == listeners_.end() ? nullptr : &it->second;
+}
+
+TCPPeer* TCPEngine::find( const FourTuple& tuple )
+{
+  const auto it = connections_.find( tuple );
+  return it == connections_.end() ? nullptr : &it->second.peer;
+}
+
+void TCPEngine::push( const FourTuple& tuple )
+{
+  const auto it = connections_.find( tuple );
+  if ( it != connections_.end() ) {
+    catch_up( it->second );
+    it->second.peer.push( it->second.transmit );
+    rearm( tuple, it->second.peer );
+  }
+}
+
+void TCPEngine::receive( InternetDatagram dgram )
+{
+  if ( dgram.header.proto != IPv4Header::PROTO_TCP ) {
+    return;
+  }
+
+  TCPSegment seg;
+  const uint32_t pseudo_checksum = dgram.header.pseudo_checksum();
+  if ( not parse( seg, move( dgram.payload ), pseudo_checksum ) ) {
+    return;
+  }
+
+  // The segment's destination is our side of the connection
+  const FourTuple tuple { dgram.header.dst, seg.udinfo.dst_port, dgram.header.src, seg.udinfo.src_port };
+  const auto it = connections_.find( tuple );
+  Connection* connection = it == connections_.end() ? nullptr : &it->second;
+  if ( not connection ) {
+    // A segment for no connection may be part of a handshake with a listener
+    const auto listener = listeners_.find( tuple.local_port );
+    if ( listener == listeners_.end() ) {
+      return;
+    }
+    auto handshake = listener->second.receive(
+      tuple, seg.message, [this]( const FourTuple& to, const TCPMessage& msg ) { send( to, msg ); } );
+    if ( not handshake.has_value() ) {
+      return;
+    }
+
+    // The handshake is complete: replay the SYN (and the time since it arrived) into a new TCPPeer, which
+    // answers with the SYN-ACK the listener has already sent, and then give it the ACK
+    connection = &open( tuple, handshake->config );
+    const auto discard = []( const TCPMessage& ) {};
+    connection->peer.receive( move( handshake->syn ), discard );
+    connection->peer.tick( handshake->age_ms, discard );
+    listener->second.established( tuple );
+  }
+
+  catch_up( *connection );
+  connection->peer.receive( move( seg.message ), connection->transmit );
+  rearm( tuple, connection->peer );
+}
+
+void TCPEngine::tick( uint64_t ms_since_last_tick )
+{
+  now_ms_ += ms_since_last_tick;
+
+  for ( auto& [port, listener] : listeners_ ) {
+    listener.tick( ms_since_last_tick, [this]( const FourTuple& to, const TCPMessage& msg ) { send( to, msg ); } );
+  }
+
+  timers_.advance( now_ms_, [this]( const FourTuple& tuple ) { expire( tuple ); } );
+}
+
+optional<uint64_t> TCPEngine::ms_until_timer() const
+{
+  optional<uint64_t> result;
+  const auto sooner = [&]( uint64_t ms ) { result = min( result.value_or( ms ), ms ); };
+
+  if ( const optional<uint64_t> next = timers_.next_event() ) {
+    sooner( *next - min( *next, now_ms_ ) );
+  }
+  for ( const auto& [port, listener] : listeners_ ) {
+    if ( const optional<uint64_t> ms = listener.ms_until_timer() ) {
+      sooner( *ms );
+    }
+  }
+  return result;
+}
+
+void TCPEngine::serve( EventLoop& loop, FileDescriptor& fd )
+{
+  loop.add_rule( "receive datagrams for the TCP engine", fd, Direction::In, [this, &fd] {
+    vector<string> strs( 3 );
+    strs[0].resize( IPv4Header::LENGTH );
+    strs[1].resize( TCPSegment::HEADER_LENGTH );
+    fd.read( strs );
+
+    InternetDatagram dgram;
+    if ( parse( dgram, move( strs ) ) ) {
+      receive( move( dgram ) );
+    }
+  } );
+
+  loop.add_rule(
+    "send datagrams from the TCP engine",
+    fd,
+    Direction::Out,
+    [this, &fd] {
+      while ( not datagrams_out_.empty() ) {
+        fd.write( serialize( datagrams_out_.front() ) );
+        datagrams_out_.pop();
+      }
+    },
+    [this] { return not datagrams_out_.empty(); } );
+}
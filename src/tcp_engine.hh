@@ -0,0 +1,112 @@
+#pragma once
+
+#include "address.hh"
+#include "eventloop.hh"
+#include "file_descriptor.hh"
+#include "four_tuple.hh"
+#include "ipv4_datagram.hh"
+#include "tcp_config.hh"
+#include "tcp_listener.hh"
+#include "tcp_peer.hh"
+#include "timer_wheel.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+// \brief Many TCP connections sharing one network interface.
+//
+// Each datagram received is handed to the TCPPeer that its addresses and ports belong to (found in a hash table),
+// and the segments every connection sends join one queue of outgoing datagrams. Unlike a TCPMinnowSocket, which
+// needs its own thread, event loop and device for each connection, one engine serves thousands. Segments for no
+// connection go to the TCPListener on their port, if there is one.
+//
+// A connection's clock only moves when something happens to it: a segment arrives, the application pushes, or
+// one of its timers (set on a TimerWheel shared by all the connections) goes off. An idle connection costs
+// nothing as time passes.
+class TCPEngine
+{
+public:
+  // How often a finished connection is looked at again, until the application has read what it received
+  static constexpr uint64_t FORGET_POLL_MS = 100;
+
+  explicit TCPEngine( const TCPConfig& config ) : config_( config ) {}
+
+  // Open a connection from `local` to `remote` (sending its SYN)
+  FourTuple connect( const Address& local, const Address& remote );
+
+  // Accept connections to `port`, on any local address: up to `backlog` of them can wait to be accepted, and up
+  // to `syn_queue_length` can be half-open (SYN cookies answer the rest, unless the config turns them off)
+  void listen( uint16_t port,
+               size_t backlog = TCPListener::DEFAULT_BACKLOG,
+               size_t syn_queue_length = TCPListener::DEFAULT_SYN_QUEUE_LENGTH );
+
+  // A connection that a peer opened to `port`, if one is waiting to be accepted
+  std::optional<FourTuple> accept( uint16_t port );
+
+  // The listener on `port` (nullptr if there is none)
+  const TCPListener* listener( uint16_t port ) const;
+
+  // The connection with these addresses and ports (nullptr if there is none, or it has been forgotten)
+  TCPPeer* find( const FourTuple& tuple );
+
+  // Send what a connection can, after its outbound stream has been written to (or closed)
+  void push( const FourTuple& tuple );
+
+  // Hand a datagram from the network to its connection
+  void receive( InternetDatagram dgram );
+
+  // Let time pass: run the timers that go off, and forget connections that have finished (once their data has
+  // been read)
+  void tick( uint64_t ms_since_last_tick );
+
+  // How many milliseconds until tick() next has something to do, for a connection or a listener (no value if
+  // nothing will happen until a segment arrives or is pushed)
+  std::optional<uint64_t> ms_until_timer() const;
+
+  // Datagrams sent by all the connections, waiting to go out on the network
+  std::queue<InternetDatagram>& datagrams_out() { return datagrams_out_; }
+
+  // How many connections are open
+  size_t connections() const { return connections_.size(); }
+
+  // How many of them have a timer set (the others are idle until a segment arrives or is pushed)
+  size_t timers() const { return timers_.size(); }
+
+  // Add rules to `loop` that read datagrams from `fd` (a TUN device) into the engine, and write the engine's
+  // outgoing datagrams to it. (The owner of the loop still calls tick() as time passes.)
+  void serve( EventLoop& loop, FileDescriptor& fd );
+
+private:
+  struct Connection
+  {
+    TCPPeer peer;
+    TCPPeer::TransmitFunction transmit; // wraps the connection's segments in datagrams, onto datagrams_out_
+    uint64_t clock_ms;                  // the engine's time when the peer was last ticked
+
+    Connection( const TCPConfig& config, TCPPeer::TransmitFunction s_transmit, uint64_t now_ms )
+      : peer( config ), transmit( std::move( s_transmit ) ), clock_ms( now_ms )
+    {}
+  };
+
+  TCPConfig config_;
+  std::unordered_map<FourTuple, Connection> connections_ {};
+  std::unordered_map<uint16_t, TCPListener> listeners_ {};
+  std::queue<InternetDatagram> datagrams_out_ {};
+  std::default_random_engine rng_ { std::random_device()() }; // for initial sequence numbers
+
+  uint64_t now_ms_ {};              // total time passed to tick()
+  TimerWheel<FourTuple> timers_ {}; // when each connection next has something to do
+
+  Connection& open( const FourTuple& tuple, const TCPConfig& config ); // add a connection to the table
+  void send( const FourTuple& tuple, const TCPMessage& msg );          // wrap a segment onto datagrams_out_
+  void catch_up( Connection& connection );                             // tick a peer up to the engine's time
+  void rearm( const FourTuple& tuple, const TCPPeer& peer );           // set a connection's timer
+  void expire( const FourTuple& tuple );                               // a connection's timer went off
+};
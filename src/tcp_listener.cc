@@ -0,0 +1,283 @@
+#include "tcp_listener.hh"
+
+#include <algorithm>
+#include <bit>
+#include <initializer_list>
+#include <utility>
+
+using namespace std;
+
+namespace {
+
+// The MSS values a SYN cookie can encode (in its three MSS bits), smallest first
+constexpr array<uint16_t, 6> COOKIE_MSS { 536, 1220, 1440, 1460, 4312, 8960 };
+
+// SipHash-2-4 of a message of 64-bit words: a keyed hash, so that a peer can't forge cookies without the key
+uint64_t siphash( const array<uint64_t, 2>& key, initializer_list<uint64_t> words )
+{
+  uint64_t v0 = 0x736f6d6570736575 ^ key[0];
+  uint64_t v1 = 0x646f72616e646f6d ^ key[1];
+  uint64_t v2 = 0x6c7967656e657261 ^ key[0];
+  uint64_t v3 = 0x7465646279746573 ^ key[1];
+
+  const auto round = [&] {
+    v0 += v1;
+    v1 = rotl( v1, 13 ) ^ v0;
+    v0 = rotl( v0, 32 );
+    v2 += v3;
+    v3 = rotl( v3, 16 ) ^ v2;
+    v0 += v3;
+    v3 = rotl( v3, 21 ) ^ v0;
+    v2 += v1;
+    v1 = rotl( v1, 17 ) ^ v2;
+    v2 = rotl( v2, 32 );
+  };
+  const auto compress = [&]( uint64_t m ) {
+    v3 ^= m;
+    round();
+    round();
+    v0 ^= m;
+  };
+
+  for ( const uint64_t word : words ) {
+    compress( word );
+  }
+  compress( static_cast<uint64_t>( words.size() * sizeof( uint64_t ) ) << 56 );
+
+  v2 ^= 0xff;
+  for ( unsigned i = 0; i < 4; i++ ) {
+    round();
+  }
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+uint32_t raw( Wrap32 seqno )
+{
+  return static_cast<uint32_t>( seqno.unwrap( Wrap32 { 0 }, 0 ) );
+}
+
+} // namespace
+
+TCPListener::TCPListener( const TCPConfig& config, size_t backlog, size_t syn_queue_length )
+  : config_( config ), backlog_( backlog ), syn_queue_length_( syn_queue_length ), rng_()
+{
+  random_device rd;
+  rng_.seed( rd() );
+  for ( auto& word : cookie_key_ ) {
+    word = static_cast<uint64_t>( rd() ) << 32 | rd();
+  }
+}
+
+TCPMessage TCPListener::syn_ack( const HalfOpen& half_open ) const
+{
+  // Offer what our TCPPeer's own SYN would: the same options, and a timestamp on the clock it will start with.
+  // After a cookie, only the MSS (the cookie can't remember anything else about the peer's SYN).
+  TCPSenderMessage sender { .seqno = half_open.isn, .SYN = true, .mss = config_.mss };
+  TCPReceiverMessage receiver { .ackno = half_open.peer_isn + 1 };
+  if ( not half_open.from_cookie ) {
+    sender.SACK_permitted = config_.sack;
+    if ( config_.window_scaling and half_open.peer_window_scale.has_value() ) { // (RFC 7323 section 2.2)
+      sender.window_scale = config_.recv_window_scale();
+    }
+    if ( config_.timestamps and half_open.peer_timestamp.has_value() ) { // (RFC 7323 section 3.2)
+      sender.timestamp = static_cast<uint32_t>( now_ms_ - half_open.syn_ms );
+      receiver.timestamp_echo = half_open.peer_timestamp;
+    }
+  }
+  // (a SYN's window is never scaled, RFC 7323 section 2.2)
+  receiver.window_size = static_cast<uint16_t>( min<uint64_t>( config_.recv_capacity, UINT16_MAX ) );
+
+  return { move( sender ), move( receiver ) };
+}
+
+TCPListener::Handshake TCPListener::handshake( const HalfOpen& half_open ) const
+{
+  Handshake result { .config = config_, .syn = {}, .age_ms = now_ms_ - half_open.syn_ms };
+  result.config.isn = half_open.isn;
+
+  // Our SYN-ACK offered no options after a cookie, and never any that the peer's SYN didn't
+  if ( half_open.from_cookie ) {
+    result.config.sack = result.config.window_scaling = result.config.timestamps = false;
+  }
+  result.config.window_scaling &= half_open.peer_window_scale.has_value();
+  result.config.timestamps &= half_open.peer_timestamp.has_value();
+
+  // The peer's SYN as it was parsed from the wire (with its options on both halves)
+  result.syn.sender = TCPSenderMessage { .seqno = half_open.peer_isn,
+                                         .SYN = true,
+                                         .SACK_permitted = half_open.peer_sack,
+                                         .window_scale = half_open.peer_window_scale,
+                                         .timestamp = half_open.peer_timestamp,
+                                         .mss = half_open.peer_mss };
+  result.syn.receiver = TCPReceiverMessage {
+    .window_size = half_open.peer_window,
+    .window_scale = half_open.peer_window_scale,
+    .timestamp_echo = half_open.peer_timestamp.has_value() ? optional<uint32_t> { 0 } : nullopt,
+    .mss = half_open.peer_mss };
+  return result;
+}
+
+optional<TCPListener::Handshake> TCPListener::receive( const FourTuple& tuple,
+                                                       const TCPMessage& msg,
+                                                       const SendFunction& send )
+{
+  const TCPSenderMessage& sender = msg.sender;
+  const TCPReceiverMessage& receiver = msg.receiver;
+  const auto it = syn_queue_.find( tuple );
+
+  if ( sender.RST ) {
+    if ( it != syn_queue_.end() ) {
+      syn_ack_timers_.cancel( tuple );
+      syn_queue_.erase( it );
+    }
+    return {};
+  }
+
+  if ( sender.SYN ) {
+    if ( receiver.ackno.has_value() ) {
+      return {};
+    }
+
+    // A SYN we've already answered means that our SYN-ACK was lost
+    if ( it != syn_queue_.end() ) {
+      send( tuple, syn_ack( it->second ) );
+      return {};
+    }
+
+    // (Like Linux, don't start handshakes that couldn't be accepted)
+    if ( backlog_full() ) {
+      return {};
+    }
+
+    HalfOpen half_open { .isn = Wrap32 { 0 },
+                         .peer_isn = sender.seqno,
+                         .peer_window = receiver.window_size,
+                         .peer_mss = sender.mss,
+                         .peer_window_scale = sender.window_scale,
+                         .peer_timestamp = sender.timestamp,
+                         .peer_sack = sender.SACK_permitted,
+                         .syn_ms = now_ms_ };
+
+    if ( syn_queue_.size() < syn_queue_length_ ) {
+      half_open.isn = Wrap32 { uniform_int_distribution<uint32_t> {}( rng_ ) };
+      send( tuple, syn_ack( half_open ) );
+      syn_queue_.emplace( tuple, half_open );
+      syn_ack_timers_.schedule( tuple, now_ms_ + config_.rt_timeout );
+    } else if ( config_.syn_cookies ) {
+      // Encode the largest MSS the peer can take (RFC 9293 says to assume 536 without the option)
+      const uint16_t peer_mss = sender.mss.value_or( COOKIE_MSS.front() );
+      uint32_t mss_index = 0;
+      while ( mss_index + 1 < COOKIE_MSS.size() and COOKIE_MSS.at( mss_index + 1 ) <= peer_mss ) {
+        mss_index++;
+      }
+      half_open.isn = Wrap32 { cookie( tuple, sender.seqno, now_ms_ / COOKIE_PERIOD_MS, mss_index ) };
+      half_open.from_cookie = true;
+      send( tuple, syn_ack( half_open ) );
+      cookies_sent_++;
+    }
+    return {};
+  }
+
+  if ( not receiver.ackno.has_value() ) {
+    return {};
+  }
+
+  // The ACK of a SYN-ACK from the SYN queue completes its handshake. If the backlog is full, it is dropped: the
+  // handshake completes with a later ACK, or the one the next SYN-ACK retransmission draws.
+  if ( it != syn_queue_.end() ) {
+    if ( receiver.ackno != it->second.isn + 1 or backlog_full() ) {
+      return {};
+    }
+    Handshake result = handshake( it->second );
+    syn_ack_timers_.cancel( tuple );
+    syn_queue_.erase( it );
+    return result;
+  }
+
+  // Otherwise, it may be the ACK of a SYN cookie
+  if ( not config_.syn_cookies or backlog_full() ) {
+    return {};
+  }
+  const Wrap32 peer_isn = sender.seqno + UINT32_MAX; // (one before the seqno that follows the SYN)
+  const Wrap32 isn = *receiver.ackno + UINT32_MAX;
+  const optional<uint16_t> mss = check_cookie( tuple, peer_isn, isn );
+  if ( not mss.has_value() ) {
+    return {};
+  }
+  return handshake( HalfOpen { .isn = isn,
+                               .peer_isn = peer_isn,
+                               .peer_window = receiver.window_size,
+                               .peer_mss = mss,
+                               .from_cookie = true,
+                               .syn_ms = now_ms_ } );
+}
+
+void TCPListener::tick( uint64_t ms_since_last_tick, const SendFunction& send )
+{
+  now_ms_ += ms_since_last_tick;
+
+  syn_ack_timers_.advance( now_ms_, [&]( const FourTuple& tuple ) {
+    const auto it = syn_queue_.find( tuple );
+    if ( it == syn_queue_.end() ) {
+      return;
+    }
+    HalfOpen& half_open = it->second;
+    if ( half_open.retx_count >= MAX_SYN_ACK_RETX ) {
+      syn_queue_.erase( it );
+      return;
+    }
+    half_open.retx_count++;
+    const uint64_t backoff = static_cast<uint64_t>( config_.rt_timeout ) << half_open.retx_count;
+    syn_ack_timers_.schedule( tuple, now_ms_ + backoff );
+    send( tuple, syn_ack( half_open ) );
+  } );
+}
+
+optional<uint64_t> TCPListener::ms_until_timer() const
+{
+  const optional<uint64_t> next = syn_ack_timers_.next_event();
+  if ( not next.has_value() ) {
+    return {};
+  }
+  return *next - min( *next, now_ms_ );
+}
+
+optional<FourTuple> TCPListener::accept()
+{
+  if ( accept_queue_.empty() ) {
+    return {};
+  }
+  const FourTuple tuple = accept_queue_.front();
+  accept_queue_.pop();
+  return tuple;
+}
+
+// A cookie is the ISN of a SYN-ACK: five bits of the time (in COOKIE_PERIOD_MS), three bits for the MSS, and 24
+// bits of a keyed hash over the connection, the peer's ISN and the other eight bits
+uint32_t TCPListener::cookie( const FourTuple& tuple, Wrap32 peer_isn, uint64_t counter, uint32_t mss_index ) const
+{
+  const uint64_t hash = siphash( cookie_key_,
+                                 { static_cast<uint64_t>( tuple.local_address ) << 32 | tuple.remote_address,
+                                   static_cast<uint64_t>( tuple.local_port ) << 48
+                                     | static_cast<uint64_t>( tuple.remote_port ) << 32 | raw( peer_isn ),
+                                   counter << 3 | mss_index } );
+  return static_cast<uint32_t>( ( counter & 0x1f ) << 27 | mss_index << 24 | ( hash & 0xffffff ) );
+}
+
+// The MSS that a cookie encodes, if it is one we made for this connection in the current or the previous period
+optional<uint16_t> TCPListener::check_cookie( const FourTuple& tuple, Wrap32 peer_isn, Wrap32 cookie_isn ) const
+{
+  const uint32_t value = raw( cookie_isn );
+  const uint32_t mss_index = value >> 24 & 0x7;
+  if ( mss_index >= COOKIE_MSS.size() ) {
+    return {};
+  }
+
+  const uint64_t now = now_ms_ / COOKIE_PERIOD_MS;
+  for ( const uint64_t counter : { now, now - 1 } ) {
+    if ( counter <= now and cookie( tuple, peer_isn, counter, mss_index ) == value ) {
+      return COOKIE_MSS.at( mss_index );
+    }
+  }
+  return {};
+}
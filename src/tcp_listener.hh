@@ -0,0 +1,100 @@
+#pragma once
+
+#include "four_tuple.hh"
+#include "tcp_config.hh"
+#include "tcp_segment.hh"
+#include "timer_wheel.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <random>
+#include <unordered_map>
+
+// \brief The passive side of a TCP port: it answers SYNs and hands back each connection whose handshake is done.
+//
+// A connection isn't given a TCPPeer (with its stream buffers) until the handshake completes. Until then it is a
+// small entry in the SYN queue, just enough to resend the SYN-ACK and recreate the SYN. When the SYN queue is
+// full, the listener answers with a SYN cookie instead (RFC 4987): the SYN-ACK's sequence number encodes the
+// peer's MSS under a keyed hash, and the ACK that comes back is enough to recreate the connection. Completed
+// connections wait in a bounded accept queue (the backlog).
+class TCPListener
+{
+public:
+  static constexpr size_t DEFAULT_BACKLOG = 128;           // Completed connections waiting to be accepted
+  static constexpr size_t DEFAULT_SYN_QUEUE_LENGTH = 1024; // Half-open connections, before cookies take over
+  static constexpr unsigned MAX_SYN_ACK_RETX = 5;          // SYN-ACK retransmissions before giving up (as Linux)
+  static constexpr uint64_t COOKIE_PERIOD_MS = 64000;      // A cookie is good for one to two of these
+
+  TCPListener( const TCPConfig& config, size_t backlog, size_t syn_queue_length );
+
+  // What a new connection's TCPPeer is made from, once its handshake has completed: the config to construct it
+  // with (its ISN is the one on our SYN-ACK), the peer's SYN to replay into it, and how long ago the SYN arrived
+  struct Handshake
+  {
+    TCPConfig config;
+    TCPMessage syn;
+    uint64_t age_ms {};
+  };
+
+  // Sends a message on behalf of a connection that doesn't have a TCPPeer yet
+  using SendFunction = std::function<void( const FourTuple&, const TCPMessage& )>;
+
+  // Handle a segment for this port that belongs to no established connection. A SYN is answered with a SYN-ACK;
+  // the ACK that completes a handshake returns the new connection (if the backlog has room for it).
+  std::optional<Handshake> receive( const FourTuple& tuple, const TCPMessage& msg, const SendFunction& send );
+
+  // Resend SYN-ACKs that haven't been answered, and forget half-open connections that have run out of tries
+  void tick( uint64_t ms_since_last_tick, const SendFunction& send );
+
+  // How many milliseconds until tick() next has something to do (no value if no SYN-ACK is waiting to be resent)
+  std::optional<uint64_t> ms_until_timer() const;
+
+  // Add a connection (made from a Handshake) to the accept queue
+  void established( const FourTuple& tuple ) { accept_queue_.push( tuple ); }
+
+  // Take the oldest connection off the accept queue
+  std::optional<FourTuple> accept();
+
+  bool backlog_full() const { return accept_queue_.size() >= backlog_; }
+  size_t syn_queue_size() const { return syn_queue_.size(); }
+  uint64_t cookies_sent() const { return cookies_sent_; }
+
+private:
+  // A half-open connection: what the peer's SYN offered, and our side's ISN and retransmission state
+  struct HalfOpen
+  {
+    Wrap32 isn;
+    Wrap32 peer_isn;
+    uint16_t peer_window {};
+    std::optional<uint16_t> peer_mss {};
+    std::optional<uint8_t> peer_window_scale {};
+    std::optional<uint32_t> peer_timestamp {};
+    bool peer_sack {};
+    bool from_cookie {};    // recreated from a SYN cookie (our SYN-ACK offered no options)
+    uint64_t syn_ms {};     // when the SYN arrived
+    unsigned retx_count {}; // how many times the SYN-ACK has been resent
+  };
+
+  TCPConfig config_;
+  size_t backlog_;
+  size_t syn_queue_length_;
+  uint64_t now_ms_ {};
+
+  std::unordered_map<FourTuple, HalfOpen> syn_queue_ {};
+  TimerWheel<FourTuple> syn_ack_timers_ {}; // when to resend each SYN-ACK in the SYN queue
+  std::queue<FourTuple> accept_queue_ {};
+  uint64_t cookies_sent_ {};
+
+  std::default_random_engine rng_;
+  std::array<uint64_t, 2> cookie_key_ {};
+
+  TCPMessage syn_ack( const HalfOpen& half_open ) const; // the SYN-ACK for a half-open connection
+  Handshake handshake( const HalfOpen& half_open ) const;
+
+  uint32_t cookie( const FourTuple& tuple, Wrap32 peer_isn, uint64_t counter, uint32_t mss_index ) const;
+  std::optional<uint16_t> check_cookie( const FourTuple& tuple, Wrap32 peer_isn, Wrap32 cookie_isn ) const;
+};
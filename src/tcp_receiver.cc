@@ -2,7 +2,28 @@
 
 using namespace std;
 
+void TCPReceiver::open_window() {
+  // SWS avoidance (RFC 1122 4.2.3.3): the space the application has freed up is only offered once it amounts to
+  // a full segment or half the buffer
+  if (window_edge_.has_value()) {
+    const uint64_t edge = reassembler_.writer().bytes_pushed() + reassembler_.writer().available_capacity();
+    if (edge >= *window_edge_ + sws_threshold_) {
+      window_edge_ = edge;
+    }
+  }
+}
+
+uint64_t TCPReceiver::window() const {
+  if (window_edge_.has_value()) {
+    const uint64_t pushed = reassembler_.writer().bytes_pushed();
+    return *window_edge_ > pushed ? *window_edge_ - pushed : 0;
+  }
+  return reassembler_.writer().available_capacity();
+}
+
 void TCPReceiver::receive(TCPSenderMessage message) {
+  open_window();
+
   // Handle RST flag
   if (message.RST) {
     reassembler_.reader().set_error();
@@ -12,6 +33,15 @@ void TCPReceiver::receive(TCPSenderMessage message) {
   // Process SYN flag (connection establishment)
   if (message.SYN && !isn_.has_value()) {
     isn_ = message.seqno;
+    sack_permitted_ = message.SACK_permitted;
+    // Scale our windows only if both SYNs offered it (RFC 7323)
+    if (window_scale_.has_value() && message.window_scale.has_value()) {
+      window_shift_ = *window_scale_;
+    }
+    if (timestamps_ && message.timestamp.has_value()) {
+      ts_recent_ = message.timestamp;
+    }
+    last_ack_sent_ = 1; // (whatever we reply with acknowledges the SYN)
   }
   
   // Don't process data until we've received a SYN
@@ -25,30 +55,63 @@ void TCPReceiver::receive(TCPSenderMessage message) {
   
   // Determine the stream index (0-indexed position in the stream)
   const uint64_t stream_index = message.SYN ? 0 : abs_seqno - 1;
+
+  if (ts_recent_.has_value() && message.timestamp.has_value()) {
+    // PAWS (RFC 7323 section 5): a segment stamped earlier than one we already took is an old duplicate
+    if (static_cast<int32_t>(*message.timestamp - *ts_recent_) < 0) {
+      return;
+    }
+    // Echo the segment that starts at the ackno we last sent, not one that arrived later, out of order or while
+    // an ACK was held back (section 4.3), so that the sender's RTT samples include the ACK delay
+    if (abs_seqno <= last_ack_sent_) {
+      ts_recent_ = message.timestamp;
+    }
+  }
   
   // Insert data into reassembler
-  reassembler_.insert(stream_index, message.payload, message.FIN);
+  reassembler_.insert(stream_index, move(message.payload), message.FIN);
+}
+
+optional<Wrap32> TCPReceiver::ackno() const {
+  // set ackno only if we've established a connection (received SYN)
+  if (!isn_.has_value()) {
+    return {};
+  }
+
+  // calculate absolute ackno: SYN(1) + bytes_pushed + FIN(if applicable)
+  const uint64_t abs_ackno = 1 + reassembler_.writer().bytes_pushed() 
+                            + (reassembler_.writer().is_closed() ? 1 : 0);
+  return Wrap32::wrap(abs_ackno, isn_.value());
 }
 
-TCPReceiverMessage TCPReceiver::send() const {
+TCPReceiverMessage TCPReceiver::send(bool syn_acked) const {
   TCPReceiverMessage msg;
   
-  // set ackno only if we've established a connection (received SYN)
   if (isn_.has_value()) {
-    // calculate absolute ackno: SYN(1) + bytes_pushed + FIN(if applicable)
-    const uint64_t abs_ackno = 1 + reassembler_.writer().bytes_pushed() 
-                              + (reassembler_.writer().is_closed() ? 1 : 0);
-    
-    // Convert to 32-bit wrapped sequence number
-    msg.ackno = Wrap32::wrap(abs_ackno, isn_.value());
+    msg.ackno = ackno();
+
+    msg.timestamp_echo = ts_recent_;
+
+    // Report the data held beyond the ackno (stream index i is absolute seqno i + 1)
+    if (sack_permitted_) {
+      for (const auto& [begin, end] : reassembler_.pending_ranges(TCPReceiverMessage::MAX_SACK_BLOCKS)) {
+        msg.sack.emplace_back(Wrap32::wrap(begin + 1, isn_.value()), Wrap32::wrap(end + 1, isn_.value()));
+      }
+    }
   }
   
-  // Set window size (cap at max uint16_t value)
-  const uint64_t window_size = reassembler_.reader().writer().available_capacity();
+  // Set window size, in units of 2^window_shift_ bytes once our SYN is acknowledged (cap at max uint16_t value)
+  const uint64_t window_size = window() >> (syn_acked ? window_shift_ : 0);
   msg.window_size = static_cast<uint16_t>(min(window_size, static_cast<uint64_t>(UINT16_MAX)));
   
   // Set RST flag if stream has an error
   msg.RST = reassembler_.reader().has_error();
   
   return msg;
-}
\ No newline at end of file
+}
+
+void TCPReceiver::note_ack_sent(const TCPReceiverMessage& message) {
+  if (isn_.has_value() && message.ackno.has_value()) {
+    last_ack_sent_ = message.ackno->unwrap(isn_.value(), reassembler_.writer().bytes_pushed());
+  }
+}
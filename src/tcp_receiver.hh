@@ -1,14 +1,24 @@
 #pragma once
 
 #include "reassembler.hh"
+#include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 
+#include <algorithm>
+
 class TCPReceiver
 {
 public:
-  // Construct with given Reassembler
-  explicit TCPReceiver( Reassembler&& reassembler ) : reassembler_( std::move( reassembler ) ) {}
+  // Construct with given Reassembler (and optional features)
+  explicit TCPReceiver( Reassembler&& reassembler, const TCPConfig& config = {} )
+    : reassembler_( std::move( reassembler ) )
+    , window_scale_( config.window_scaling ? std::optional<uint8_t> { config.recv_window_scale() } : std::nullopt )
+    , timestamps_( config.timestamps )
+    , sws_threshold_( std::min<uint64_t>( reassembler_.writer().available_capacity() / 2, config.mss ) )
+    , window_edge_( config.sws_avoidance ? std::optional<uint64_t> { reassembler_.writer().available_capacity() }
+                                         : std::nullopt )
+  {}
 
   /*
    * The TCPReceiver receives TCPSenderMessages, inserting their payload into the Reassembler
@@ -16,8 +26,22 @@ public:
    */
   void receive( TCPSenderMessage message );
 
-  // The TCPReceiver sends TCPReceiverMessages to the peer's TCPSender.
-  TCPReceiverMessage send() const;
+  // The TCPReceiver sends TCPReceiverMessages to the peer's TCPSender. (Until the peer has acknowledged our SYN,
+  // our windows go out unscaled: a SYN's window never is, and the peer may not have seen ours yet.)
+  TCPReceiverMessage send( bool syn_acked = true ) const;
+
+  // Record that a message from send() actually went out: its ackno is RFC 7323's Last.ACK.sent, which decides
+  // which segment's timestamp to echo
+  void note_ack_sent( const TCPReceiverMessage& message );
+
+  // The ackno that send() would put in a message now (without sending it), once the peer's SYN has arrived
+  std::optional<Wrap32> ackno() const;
+
+  // Offer the space the application has freed up (a segment or half the buffer at a time, if avoiding SWS)
+  void open_window();
+
+  // How many bytes our window offers (before it is scaled down to fit the header)
+  uint64_t window() const;
 
   // Access the output
   const Reassembler& reassembler() const { return reassembler_; }
@@ -28,4 +52,12 @@ public:
 private:
   Reassembler reassembler_;
   std::optional<Wrap32> isn_ {}; // Initial Sequence Number
+  bool sack_permitted_ {};       // Did the peer's SYN ask for SACK blocks?
+  std::optional<uint8_t> window_scale_ {}; // Window scale our SYN offers, if any
+  uint8_t window_shift_ {};                // Scale in effect for our windows (once the peer's SYN offered one too)
+  bool timestamps_ {};                     // Does our SYN offer timestamps?
+  std::optional<uint32_t> ts_recent_ {};   // Timestamp to echo (RFC 7323's TS.Recent), once both SYNs had one
+  uint64_t last_ack_sent_ {};              // Absolute ackno of the last message sent (RFC 7323's Last.ACK.sent)
+  uint64_t sws_threshold_ {};              // Smallest move of the window's right edge worth advertising
+  std::optional<uint64_t> window_edge_ {}; // Right edge of our advertised window (a stream index), if avoiding SWS
 };
\ No newline at end of file
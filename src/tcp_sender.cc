@@ -1,6 +1,10 @@
 #include "tcp_sender.hh"
 #include "tcp_config.hh"
 
+#include <algorithm>
+#include <optional>
+#include <vector>
+
 using namespace std;
 
 // Test accessor for outstanding sequence numbers
@@ -15,70 +19,250 @@ uint64_t TCPSender::consecutive_retransmissions() const
   return consecutive_retransmissions_;
 }
 
+// Test accessor for the congestion window
+uint64_t TCPSender::congestion_window() const
+{
+  return congestion_control_ ? congestion_control_->window() : UINT64_MAX;
+}
+
+uint64_t TCPSender::max_payload_size() const
+{
+  // Options that go on every segment come out of the MSS (RFC 6691). SACK blocks, which only ride along while
+  // our own receiver has holes, aren't reserved for.
+  const uint64_t options = peer_timestamps_ ? TCPConfig::TIMESTAMPS_LENGTH : 0;
+  return mss_ > options ? mss_ - options : 1;
+}
+
+uint64_t TCPSender::pacing_rate() const
+{
+  if ( !pacing_ ) {
+    return UINT64_MAX;
+  }
+  if ( pacing_rate_ > 0 ) {
+    return pacing_rate_;
+  }
+  if ( !rtt_.has_sample() ) {
+    return UINT64_MAX; // nothing to derive a rate from yet, so the first window goes out as usual
+  }
+
+  // Send a window per round trip, a little faster so that pacing itself doesn't limit the sender (and twice as
+  // fast in slow start, where the window doubles every round trip)
+  uint64_t window = congestion_control_ ? min( congestion_control_->window(), window_size_ ) : window_size_;
+  window = max( window, max_payload_size() ); // (a closed window is probed a segment at a time)
+  const bool slow_start = congestion_control_ && congestion_control_->in_slow_start();
+  const double gain = slow_start ? TCPConfig::PACING_SS_GAIN : TCPConfig::PACING_CA_GAIN;
+  const double rate = gain * static_cast<double>( window ) * 1'000'000 / max( rtt_.srtt_us(), 1.0 );
+  return max( static_cast<uint64_t>( rate ), uint64_t { 1 } );
+}
+
+uint64_t TCPSender::pacing_delay_us() const
+{
+  if ( !pacing_ || release_us_ <= time_us_ || ( !reader().bytes_buffered() && !reader().is_finished() ) ) {
+    return 0;
+  }
+  return release_us_ - time_us_;
+}
+
+uint64_t TCPSender::pacing_delay_ms() const
+{
+  return ( pacing_delay_us() + 999 ) / 1000;
+}
+
+optional<uint64_t> TCPSender::us_until_timeout() const
+{
+  if ( !timer_running_ || outstanding_messages_.empty() ) {
+    return {};
+  }
+  return current_RTO_ms_ * 1000 - min( timer_us_, current_RTO_ms_ * 1000 );
+}
+
+void TCPSender::pace( uint64_t bytes )
+{
+  const uint64_t rate = pacing_rate();
+  if ( rate == UINT64_MAX ) {
+    return;
+  }
+
+  // The clock may only advance in whole milliseconds (as with tick()), so let a segment catch up on up to a
+  // millisecond that has passed (or else the rate would be limited to one segment per tick), but no more: a
+  // sender that was idle mustn't save up a burst.
+  release_us_ = max( release_us_, time_us_ - min( time_us_, uint64_t { 1000 } ) ) + bytes * 1'000'000 / rate;
+}
+
+uint64_t TCPSender::pipe() const
+{
+  // During a fast recovery, each duplicate ack stands for a segment that has left the network, just like a SACKed
+  // one (this is NewReno's window inflation). SACKs are more precise, so count whichever accounts for more.
+  // Segments that SACKs show lost have left the network too, until they are resent (RFC 6675's pipe).
+  uint64_t delivered = sacked_bytes_;
+  if ( fast_recovery_ ) {
+    delivered = max( delivered, duplicate_acks_ * max_payload_size() );
+  }
+  delivered += lost_bytes_;
+  return bytes_in_flight_ - min( delivered, bytes_in_flight_ );
+}
+
+uint64_t TCPSender::congestion_room() const
+{
+  if ( !congestion_control_ ) {
+    return UINT64_MAX;
+  }
+
+  // Use the window in whole segments: a sliver of it would only produce a tiny segment, unless nothing is in flight
+  const uint64_t cwnd = congestion_control_->window();
+  const uint64_t room = cwnd > pipe() ? cwnd - pipe() : 0;
+  return ( room >= max_payload_size() || pipe() == 0 ) ? room : 0;
+}
+
 void TCPSender::push( const TransmitFunction& transmit )
 {
+  // Resend the front segment if duplicate acks (or a partial ack during recovery) showed that it was lost
+  if ( retransmit_front_ && !outstanding_messages_.empty() && !outstanding_messages_.front().retransmitted ) {
+    mark( outstanding_messages_.front(), &Outstanding::retransmitted );
+    outstanding_messages_.front().sent_us.reset();
+    send( outstanding_messages_.front(), transmit );
+  }
+  retransmit_front_ = false;
+
+  // Resend any holes that the peer's SACKs show were lost, before sending new data
+  if ( sack_enabled_ ) {
+    retransmit_lost( transmit );
+  }
+
   // Calculate effective window size (treat 0 window as 1 for window probing)
-  const uint16_t effective_window = window_size_ ? window_size_ : 1;
+  const uint64_t effective_window = window_size_ ? window_size_ : 1;
+
+  // Continue sending while both windows allow and FIN not yet sent
+  while ( bytes_in_flight_ < effective_window && congestion_room() > 0 && !fin_sent_
+          && ( !pacing_ || release_us_ <= time_us_ ) ) {
+    Outstanding segment { .seqno = next_seqno_, .length = 0, .SYN = !syn_sent_, .sent_us = time_us_ };
+    syn_sent_ = true;
 
-  // Continue sending while window allows and FIN not yet sent
-  while ( bytes_in_flight_ < effective_window && !fin_sent_ ) {
-    TCPSenderMessage msg = make_empty_message();
+    // Calculate available payload space considering window and existing flight
+    const uint64_t remaining_capacity = min( effective_window - bytes_in_flight_, congestion_room() );
+    const uint64_t max_payload = min( remaining_capacity - segment.SYN, // Account for SYN
+                                      max_payload_size() );
 
-    // Set SYN flag if connection not yet initiated
-    if ( !syn_sent_ ) {
-      msg.SYN = true;
-      syn_sent_ = true;
+    // Let the application's next writes fill out a small final segment, if Nagle or corking wants that
+    const uint64_t buffered = reader().bytes_buffered();
+    if ( !segment.SYN && buffered > 0 && buffered <= max_payload && buffered < max_payload_size()
+         && hold_small_segment() ) {
+      break;
     }
 
-    // Calculate available payload space considering window and existing flight
-    const uint64_t remaining_capacity = effective_window - bytes_in_flight_;
-    const size_t max_payload = min( remaining_capacity - msg.sequence_length(), // Account for SYN/FIN
-                                    TCPConfig::MAX_PAYLOAD_SIZE );
-
-    // Fill payload from input stream without exceeding capacity
-    while ( reader().bytes_buffered() && msg.payload.size() < max_payload ) {
-      const string_view data = reader().peek().substr( 0, max_payload - msg.payload.size() );
-      msg.payload += data;
+    // SWS avoidance (RFC 1122 4.2.3.4): rather than send a sliver of the window, wait for the next ack to open
+    // it further, unless the sliver is a full segment or half the largest window the receiver has offered.
+    // (With nothing in flight, there's no ack to wait for.)
+    if ( sws_avoidance_ && !segment.SYN && max_payload < buffered && max_payload < max_payload_size()
+         && max_payload < max_window_ / 2 && bytes_in_flight_ > 0 ) {
+      break;
+    }
+
+    // Copy the payload out of the input stream, into the memory of an acknowledged segment's payload if there is one
+    if ( !spare_payloads_.empty() && reader().bytes_buffered() && max_payload > 0 ) {
+      segment.payload = move( spare_payloads_.back() );
+      spare_payloads_.pop_back();
+      segment.payload.clear();
+    }
+    while ( reader().bytes_buffered() && segment.payload.size() < max_payload ) {
+      const string_view data = reader().peek().substr( 0, max_payload - segment.payload.size() );
+      segment.payload.append( data );
       reader().pop( data.size() );
     }
+    const uint64_t payload_size = segment.payload.size();
 
     // Set FIN flag if stream ended and window allows
-    if ( !fin_sent_ && reader().is_finished() && ( remaining_capacity > msg.sequence_length() ) ) {
-      msg.FIN = true;
+    if ( !fin_sent_ && reader().is_finished() && ( remaining_capacity > segment.SYN + payload_size ) ) {
+      segment.FIN = true;
       fin_sent_ = true;
     }
 
     // Skip empty segments (except for SYN/FIN)
-    if ( msg.sequence_length() == 0 )
+    segment.length = segment.SYN + payload_size + segment.FIN;
+    if ( segment.length == 0 )
       break;
 
     // Transmit segment and update tracking
-    transmit( msg );
-    next_seqno_ += msg.sequence_length();
-    bytes_in_flight_ += msg.sequence_length();
-    outstanding_messages_.push( move( msg ) );
+    send( segment, transmit );
+    pace( segment.length );
+    next_seqno_ += segment.length;
+    bytes_in_flight_ += segment.length;
+    outstanding_messages_.push_back( move( segment ) );
 
     // Start retransmission timer if not running
     if ( !timer_running_ ) {
       timer_running_ = true;
-      timer_ = 0;
+      timer_us_ = 0;
     }
   }
 }
 
+bool TCPSender::hold_small_segment() const
+{
+  // The end of the stream, and anything written before a flush, goes out right away
+  if ( writer().is_closed() || reader().bytes_popped() < flush_point_ ) {
+    return false;
+  }
+  return cork_ || ( nagle_ && bytes_in_flight_ > 0 );
+}
+
+void TCPSender::set_cork( bool on )
+{
+  // Uncorking sends what was held back (like Linux's TCP_CORK)
+  if ( cork_ && !on ) {
+    flush();
+  }
+  cork_ = on;
+}
+
+void TCPSender::flush()
+{
+  flush_point_ = writer().bytes_pushed();
+}
+
 TCPSenderMessage TCPSender::make_empty_message() const
 {
   // Construct base message with current sequence number
-  return {
+  TCPSenderMessage msg {
     .seqno = Wrap32::wrap( next_seqno_, isn_ ),
     .SYN = false,
     .payload = {},
     .FIN = false,
     .RST = input_.has_error() // Propagate stream error state
   };
+  stamp( msg );
+  return msg;
+}
+
+void TCPSender::send( Outstanding& segment, const TransmitFunction& transmit )
+{
+  segment_.seqno = Wrap32::wrap( segment.seqno, isn_ );
+  segment_.SYN = segment.SYN;
+  segment_.FIN = segment.FIN;
+  segment_.RST = input_.has_error();
+
+  // The SYN carries our options
+  segment_.SACK_permitted = segment.SYN && sack_enabled_;
+  segment_.window_scale = segment.SYN ? window_scale_ : nullopt;
+  segment_.mss = segment.SYN ? optional<uint16_t> { offered_mss_ } : nullopt;
+  segment_.timestamp.reset();
+  stamp( segment_ );
+
+  // Lend the segment's payload to the message for the call, so that no transmission copies it
+  swap( segment_.payload, segment.payload );
+  transmit( segment_ );
+  swap( segment_.payload, segment.payload );
+}
+
+void TCPSender::stamp( TCPSenderMessage& msg ) const
+{
+  // The SYN offers timestamps; once the peer's SYN has carried them too, every segment has one (RFC 7323)
+  if ( timestamps_ && ( msg.SYN || peer_timestamps_ ) ) {
+    msg.timestamp = static_cast<uint32_t>( now_ms() );
+  }
 }
 
-void TCPSender::receive( const TCPReceiverMessage& msg )
+void TCPSender::receive( const TCPReceiverMessage& msg, bool with_data )
 {
   // Handle error states
   if ( input_.has_error() )
@@ -88,8 +272,44 @@ void TCPSender::receive( const TCPReceiverMessage& msg )
     return;
   }
 
-  // Update receiver window size
-  window_size_ = msg.window_size;
+  // The peer's SYN is the first message, if it arrives before ours is sent, or else the one that first acks ours
+  const bool peer_syn = !peer_syn_received_
+                        && ( !syn_sent_
+                             || ( msg.ackno.has_value() && msg.ackno->unwrap( isn_, next_seqno_ ) > 0
+                                  && msg.ackno->unwrap( isn_, next_seqno_ ) <= next_seqno_ ) );
+  peer_syn_received_ |= peer_syn;
+
+  // If it arrives before ours is sent, ours may only offer the options it did (RFC 7323 sections 2.2 and 3.2)
+  if ( peer_syn && !syn_sent_ ) {
+    if ( !msg.window_scale.has_value() ) {
+      window_scale_.reset();
+    }
+    timestamps_ &= msg.timestamp_echo.has_value();
+  }
+
+  // Scaling only applies if both SYNs offered it (RFC 7323), and the peer's SYN itself carries an unscaled window
+  if ( msg.window_scale.has_value() && window_scale_.has_value() ) {
+    peer_window_scale_ = min( *msg.window_scale, TCPConfig::MAX_WINDOW_SCALE );
+  }
+
+  // Any timestamp option from the peer means it does timestamps too, and its SYN says how large a segment it
+  // takes (without the option, 536 bytes: RFC 9293 section 3.7.1). Both settle the segment size during the
+  // handshake.
+  const uint64_t previous_payload_size = max_payload_size();
+  peer_timestamps_ |= timestamps_ && msg.timestamp_echo.has_value();
+  if ( peer_syn || msg.mss.has_value() ) {
+    // (an absurdly small MSS would leave the whole connection sending slivers, so it is raised to a floor)
+    mss_ = min<uint64_t>( max( msg.mss.value_or( TCPConfig::DEFAULT_MSS ), TCPConfig::MIN_MSS ), offered_mss_ );
+  }
+  if ( congestion_control_ && max_payload_size() != previous_payload_size ) {
+    congestion_control_->set_mss( max_payload_size() );
+  }
+
+  // Update receiver window size (remembering the old one: a window update isn't a duplicate ack)
+  const uint64_t previous_window = window_size_;
+  const uint8_t scale = msg.window_scale.has_value() ? 0 : peer_window_scale_;
+  window_size_ = static_cast<uint64_t>( msg.window_size ) << scale;
+  max_window_ = max( max_window_, window_size_ );
 
   // Process acknowledgment if present
   if ( !msg.ackno )
@@ -103,10 +323,12 @@ void TCPSender::receive( const TCPReceiverMessage& msg )
     return; // Acknowledges unsent data
 
   bool acked = false;
+  uint64_t bytes_acked = 0;
+  optional<uint64_t> rtt_sample; // (in microseconds)
   // Process all completely acknowledged segments
   while ( !outstanding_messages_.empty() ) {
-    const auto& front_msg = outstanding_messages_.front();
-    const uint64_t segment_end = ackno_ + front_msg.sequence_length();
+    const auto& front = outstanding_messages_.front();
+    const uint64_t segment_end = ackno_ + front.length;
 
     if ( segment_end > ack_abs )
       break; // Partial acknowledgment
@@ -114,14 +336,75 @@ void TCPSender::receive( const TCPReceiverMessage& msg )
     // Update tracking information
     acked = true;
     ackno_ = segment_end;
-    bytes_in_flight_ -= front_msg.sequence_length();
-    outstanding_messages_.pop();
+    bytes_acked += front.length;
+    bytes_in_flight_ -= front.length;
+    if ( front.sacked ) {
+      sacked_bytes_ -= front.length;
+    }
+    lost_bytes_ -= front.lost_length();
+    if ( front.sent_us.has_value() ) {
+      rtt_sample = time_us_ - *front.sent_us;
+    }
+    spare_payloads_.push_back( move( outstanding_messages_.front().payload ) );
+    outstanding_messages_.pop_front();
+  }
+
+  // With timestamps, every ack that advances ackno_ can be timed, even one for a retransmission (RFC 7323 4.1).
+  // The echo only counts whole milliseconds, though, so it is the fallback for when the send times can't be used.
+  if ( acked && !rtt_sample.has_value() && peer_timestamps_ && msg.timestamp_echo.has_value() ) {
+    rtt_sample = uint64_t { static_cast<uint32_t>( now_ms() ) - *msg.timestamp_echo } * 1000;
+  }
+
+  if ( rtt_sample.has_value() ) {
+    rtt_.sample( *rtt_sample );
+    if ( congestion_control_ ) {
+      congestion_control_->on_rtt_sample( *rtt_sample / 1000 );
+    }
+  }
+
+  // Tell the congestion controller (the window doesn't grow during a fast recovery, which ends once
+  // everything that was outstanding at the loss has been acknowledged)
+  if ( acked ) {
+    if ( congestion_control_ && !fast_recovery_ ) {
+      congestion_control_->on_ack( bytes_acked, now_ms() );
+    }
+    fast_recovery_ &= ackno_ < recovery_point_;
+
+    // Keep spare payloads for no more segments than the window now allows, so a burst's memory isn't held forever
+    const uint64_t window = congestion_control_ ? min( congestion_control_->window(), window_size_ ) : window_size_;
+    spare_payloads_.resize( min<uint64_t>( spare_payloads_.size(), window / max_payload_size() ) );
+  }
+
+  // A duplicate ack (RFC 5681 section 2) means a segment beyond a hole reached the receiver. (One that comes
+  // with data or a SYN or FIN is just the peer sending, and says nothing about our segments.)
+  if ( acked ) {
+    duplicate_acks_ = 0;
+  } else if ( !with_data && ack_abs == ackno_ && !outstanding_messages_.empty()
+              && window_size_ == previous_window ) {
+    duplicate_acks_++;
+  }
+
+  if ( fast_retransmit_ ) {
+    if ( duplicate_acks_ == TCPConfig::DUP_THRESH && ackno_ >= recovery_point_ ) {
+      // Fast retransmit: the hole is the front segment
+      enter_recovery();
+      retransmit_front_ = true;
+    } else if ( acked && ackno_ < recovery_point_ ) {
+      // A partial ack (RFC 6582), in a fast recovery or after a timeout: the segment after the repaired hole was
+      // lost as well
+      retransmit_front_ = true;
+    }
+  }
+
+  // Record which of the remaining segments the peer already holds
+  if ( sack_enabled_ ) {
+    mark_sacked( msg );
   }
 
   // Reset timer state if any segments were acknowledged
   if ( acked ) {
-    timer_ = 0;
-    current_RTO_ms_ = initial_RTO_ms_;
+    timer_us_ = 0;
+    current_RTO_ms_ = adaptive_rto_ ? rtt_.rto_ms() : initial_RTO_ms_;
     consecutive_retransmissions_ = 0;
     timer_running_ = !outstanding_messages_.empty();
   }
@@ -129,23 +412,146 @@ void TCPSender::receive( const TCPReceiverMessage& msg )
 
 void TCPSender::tick( uint64_t ms_since_last_tick, const TransmitFunction& transmit )
 {
+  tick_us( ms_since_last_tick * 1000, transmit );
+}
+
+void TCPSender::tick_us( uint64_t us_since_last_tick, const TransmitFunction& transmit )
+{
+  time_us_ += us_since_last_tick;
+
   // Update timer only when active
   if ( timer_running_ ) {
-    timer_ += ms_since_last_tick;
+    timer_us_ += us_since_last_tick;
   }
 
   // Check for timeout condition
-  if ( timer_running_ && timer_ >= current_RTO_ms_ && !outstanding_messages_.empty() ) {
+  if ( timer_running_ && timer_us_ >= current_RTO_ms_ * 1000 && !outstanding_messages_.empty() ) {
+    // Any hole that was already repaired may have been lost again, so let it be retransmitted once more.
+    // (The SACKed marks stay: the receiver only repeats its most recent blocks, so they can't be rebuilt.)
+    for ( auto& segment : outstanding_messages_ ) {
+      lost_bytes_ -= segment.lost_length();
+      segment.retransmitted = false;
+      lost_bytes_ += segment.lost_length();
+    }
+    next_hole_ = 0;
+
     // Retransmit oldest unacknowledged segment
-    transmit( outstanding_messages_.front() );
+    send( outstanding_messages_.front(), transmit );
+    mark( outstanding_messages_.front(), &Outstanding::retransmitted );
+    outstanding_messages_.front().sent_us.reset();
 
-    // Apply exponential backoff only when window is open
+    // Apply exponential backoff (and treat the timeout as congestion) only when window is open
     if ( window_size_ > 0 ) {
+      // (Only the first timeout of a segment is a new congestion signal: resending it again leaves ssthresh
+      // alone, RFC 5681 section 3.1)
+      if ( congestion_control_ && consecutive_retransmissions_ == 0 ) {
+        congestion_control_->on_rto( bytes_in_flight_, now_ms() );
+      }
       consecutive_retransmissions_++;
-      current_RTO_ms_ *= 2;
+      current_RTO_ms_ = adaptive_rto_ ? min( 2 * current_RTO_ms_, max_RTO_ms_ ) : 2 * current_RTO_ms_;
+      recovery_point_ = next_seqno_; // (partial acks up to here still resend the next hole, RFC 6582 section 4)
+      fast_recovery_ = false;        // slow start begins right away
+      duplicate_acks_ = 0;
     }
 
     // Reset timer for next potential retransmission
-    timer_ = 0;
+    timer_us_ = 0;
+  }
+
+  // Release whatever pacing was holding back
+  if ( pacing_ ) {
+    push( transmit );
+  }
+}
+
+void TCPSender::enter_recovery()
+{
+  // The first loss in a window of data is a congestion signal
+  if ( congestion_control_ ) {
+    congestion_control_->on_loss( bytes_in_flight_, now_ms() );
+  }
+  recovery_point_ = next_seqno_;
+  fast_recovery_ = true;
+}
+
+deque<TCPSender::Outstanding>::iterator TCPSender::find_segment( uint64_t seqno )
+{
+  return ranges::lower_bound( outstanding_messages_, seqno, {}, &Outstanding::seqno );
+}
+
+void TCPSender::mark_sacked( const TCPReceiverMessage& msg )
+{
+  for ( const auto& [left, right] : msg.sack ) {
+    const uint64_t begin = left.unwrap( isn_, next_seqno_ );
+    const uint64_t end = right.unwrap( isn_, next_seqno_ );
+    if ( end > next_seqno_ ) {
+      continue; // Covers data we never sent
+    }
+
+    // Segments are the unit of retransmission, so only whole segments count
+    for ( auto it = find_segment( begin ); it != outstanding_messages_.end() && it->seqno + it->length <= end;
+          ++it ) {
+      if ( !it->sacked ) {
+        mark( *it, &Outstanding::sacked );
+        sacked_bytes_ += it->length;
+        highest_sacked_ = max( highest_sacked_, it->seqno + it->length );
+      }
+    }
+  }
+}
+
+void TCPSender::mark( Outstanding& segment, bool Outstanding::*flag )
+{
+  lost_bytes_ -= segment.lost_length();
+  segment.*flag = true;
+  lost_bytes_ += segment.lost_length();
+}
+
+void TCPSender::retransmit_lost( const TransmitFunction& transmit )
+{
+  // A segment is lost once DUP_THRESH later segments have been SACKed (RFC 6675's IsLost(), in segments), so
+  // every un-SACKed segment below the DUP_THRESH-th highest SACKed one is. Count down from the highest SACKed
+  // segment to find it; the boundary only ever rises, so there's no need to look below where it was.
+  uint64_t boundary = loss_boundary_;
+  unsigned sacked_above = 0;
+  for ( auto it = find_segment( highest_sacked_ );
+        it != outstanding_messages_.begin() && sacked_above < TCPConfig::DUP_THRESH; ) {
+    --it;
+    if ( it->seqno < loss_boundary_ ) {
+      break;
+    }
+    if ( it->sacked && ++sacked_above == TCPConfig::DUP_THRESH ) {
+      boundary = it->seqno;
+    }
+  }
+
+  // Mark the segments that the boundary passed
+  bool new_loss = false;
+  for ( auto it = find_segment( loss_boundary_ ); it != outstanding_messages_.end() && it->seqno < boundary; ++it ) {
+    if ( !it->sacked && !it->lost ) {
+      mark( *it, &Outstanding::lost );
+      new_loss = true;
+    }
+  }
+  loss_boundary_ = boundary;
+
+  if ( new_loss && ackno_ >= recovery_point_ ) {
+    enter_recovery();
   }
-}
\ No newline at end of file
+
+  // Fill the holes lowest first, while the congestion window has room (RFC 6675's NextSeg()), starting from the
+  // first one not yet repaired. Each loss is repaired once; if the retransmission is lost too, the RTO takes over.
+  auto it = find_segment( next_hole_ );
+  for ( ; it != outstanding_messages_.end() && it->seqno < loss_boundary_; ++it ) {
+    if ( it->lost_length() == 0 ) {
+      continue;
+    }
+    if ( congestion_room() == 0 ) {
+      break;
+    }
+    mark( *it, &Outstanding::retransmitted );
+    it->sent_us.reset();
+    send( *it, transmit );
+  }
+  next_hole_ = it == outstanding_messages_.end() ? next_seqno_ : it->seqno;
+}
@@ -1,27 +1,54 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "rtt_estimator.hh"
+#include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 
+#include <deque>
 #include <functional>
-#include <queue>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 class TCPSender
 {
 public:
-  /* Construct TCP sender with given default Retransmission Timeout and possible ISN */
-  TCPSender( ByteStream&& input, Wrap32 isn, uint64_t initial_RTO_ms ) 
-    : input_( std::move( input ) ), isn_( isn ), initial_RTO_ms_( initial_RTO_ms ), current_RTO_ms_( initial_RTO_ms )
+  /* Construct TCP sender with given default Retransmission Timeout and possible ISN (and optional features) */
+  TCPSender( ByteStream&& input, Wrap32 isn, uint64_t initial_RTO_ms, const TCPConfig& config = {} )
+    : input_( std::move( input ) )
+    , isn_( isn )
+    , sack_enabled_( config.sack )
+    , fast_retransmit_( config.fast_retransmit )
+    , window_scale_( config.window_scaling ? std::optional<uint8_t> { config.recv_window_scale() } : std::nullopt )
+    , timestamps_( config.timestamps )
+    , offered_mss_( config.mss )
+    , mss_( config.mss )
+    , nagle_( config.nagle )
+    , cork_( config.cork )
+    , sws_avoidance_( config.sws_avoidance )
+    , pacing_( config.pacing )
+    , pacing_rate_( config.pacing_rate )
+    , congestion_control_( CongestionControl::make( config.congestion_control, config.mss ) )
+    , initial_RTO_ms_( initial_RTO_ms )
+    , current_RTO_ms_( initial_RTO_ms )
+    , adaptive_rto_( config.adaptive_rto )
+    , max_RTO_ms_( config.max_rto_ms )
+    , rtt_( initial_RTO_ms, config.min_rto_ms, config.max_rto_ms )
   {}
 
   /* Generate an empty TCPSenderMessage */
   TCPSenderMessage make_empty_message() const;
 
-  /* Receive and process a TCPReceiverMessage from the peer's receiver */
-  void receive( const TCPReceiverMessage& msg );
+  /* Receive and process a TCPReceiverMessage from the peer's receiver (`with_data`: the segment that carried it
+   * also took up sequence numbers, so it can't count as a duplicate ack) */
+  void receive( const TCPReceiverMessage& msg, bool with_data = false );
 
-  /* Type of the `transmit` function that the push and tick methods can use to send messages */
+  /* Type of the `transmit` function that the push and tick methods can use to send messages
+   * (the message is only valid during the call: the sender reuses it for the next one) */
   using TransmitFunction = std::function<void( const TCPSenderMessage& )>;
 
   /* Push bytes from the outbound stream */
@@ -30,15 +57,35 @@ public:
   /* Time has passed by the given # of milliseconds since the last time the tick() method was called */
   void tick( uint64_t ms_since_last_tick, const TransmitFunction& transmit );
 
+  /* The same, with a clock that counts microseconds */
+  void tick_us( uint64_t us_since_last_tick, const TransmitFunction& transmit );
+
+  /* Small-write coalescing: a segment smaller than the MSS that would empty the outbound stream is held back,
+   * with Nagle's algorithm while data is unacknowledged, or while corked until flushed or uncorked */
+  void set_nagle( bool on ) { nagle_ = on; }
+  void set_cork( bool on );
+  void flush(); // Let the next push() send everything written so far, however small the last segment
+  bool nagle() const { return nagle_; }
+  bool corked() const { return cork_; }
+
   // Accessors
   uint64_t sequence_numbers_in_flight() const;  // For testing: how many sequence numbers are outstanding?
   uint64_t consecutive_retransmissions() const; // For testing: how many consecutive retransmissions have happened?
+  uint64_t congestion_window() const;           // For testing: congestion window (UINT64_MAX if there is none)
+  uint64_t max_payload_size() const;            // Largest payload per segment: the MSS, less per-segment options
+  bool syn_acked() const { return ackno_ > 0; } // Has the receiver acknowledged our SYN?
+  uint64_t pacing_rate() const;                 // Bytes per second that pacing allows (UINT64_MAX if unpaced)
+  uint64_t pacing_delay_ms() const;             // How long pacing holds back data ready to go (0 if it is not)
+  uint64_t pacing_delay_us() const;             // The same, in microseconds
+  std::optional<uint64_t> us_until_timeout() const; // Time left on the retransmission timer (if it is running)
+  const RTTEstimator& rtt_estimator() const { return rtt_; } // Round-trip time estimates, and the RTO they give
   const Writer& writer() const { return input_.writer(); }
   const Reader& reader() const { return input_.reader(); }
   Writer& writer() { return input_.writer(); }
 
 private:
   Reader& reader() { return input_.reader(); }
+  uint64_t now_ms() const { return time_us_ / 1000; } // the clock, in the milliseconds timestamps count
 
   ByteStream input_;                     // the outbound stream used to read data to send
   Wrap32 isn_;                           // initial Sequence Number
@@ -46,20 +93,82 @@ private:
   /* State flag */
   bool syn_sent_{};                        // has the SYN flag been sent?
   bool fin_sent_{};                        // has the FIN flag been sent?
+  bool peer_syn_received_{};               // has the peer's SYN (or SYN-ACK) arrived?
+  bool sack_enabled_{};                    // offer SACK on the SYN, and retransmit the holes it reveals?
+  bool fast_retransmit_{};                 // retransmit the front segment after DUP_THRESH duplicate acks?
+  std::optional<uint8_t> window_scale_{};  // window scale to offer on the SYN (our receiver's), if any
+  bool timestamps_{};                      // offer timestamps on the SYN?
+  bool peer_timestamps_{};                 // has the peer sent timestamps too (so every segment carries one)?
+  uint16_t offered_mss_{};                 // largest payload we accept, offered on the SYN
+  uint64_t mss_{};                         // largest payload we send (the smaller of ours and the peer's)
+  bool nagle_{};                           // hold back a small segment while data is in flight?
+  bool cork_{};                            // hold back a small segment until flushed?
+  uint64_t flush_point_{};                 // bytes written before the last flush (not to be held back)
+  bool sws_avoidance_{};                   // wait for a useful window instead of sending slivers?
+  bool pacing_{};                          // space new segments out at pacing_rate()?
+  uint64_t pacing_rate_{};                 // configured pacing rate in bytes per second (0: derive it)
+  uint64_t release_us_{};                  // when pacing next lets a segment go (on the time_us_ clock)
   
   /* Window management */
-  uint16_t window_size_{ 1 };                 // size of the receiver's window
+  uint64_t window_size_{ 1 };                 // size of the receiver's window, in bytes
+  uint64_t max_window_{};                  // largest window the receiver has advertised
+  uint8_t peer_window_scale_{};            // how far to shift the receiver's advertised windows
   uint64_t next_seqno_{};                  // next sequence number to be sent
   uint64_t ackno_{};                       // acknowledgment number of the receiver
   uint64_t bytes_in_flight_{};             // number of bytes sent but not acknowledged
+  uint64_t sacked_bytes_{};                // number of bytes in flight that the receiver SACKed
+  uint64_t lost_bytes_{};                  // number of bytes in flight that SACKs showed lost, not yet resent
+  uint64_t highest_sacked_{};              // end of the highest segment the receiver has SACKed
+  uint64_t loss_boundary_{};               // un-SACKed segments below this are lost (DUP_THRESH SACKed above them)
+  uint64_t next_hole_{};                   // no lost segment below this is still waiting to be resent
+
+  /* Congestion control */
+  std::unique_ptr<CongestionControl> congestion_control_; // limits bytes in flight (nullptr: no limit)
+  uint64_t recovery_point_{};              // next_seqno_ at the last loss (no more reductions until it's acked)
+  bool fast_recovery_{};                   // repairing a loss detected without a timeout (the window is frozen)?
+  uint64_t duplicate_acks_{};              // acks in a row that didn't advance ackno_ (each means a segment arrived)
+  bool retransmit_front_{};                // should the next push() resend the front segment?
+  uint64_t time_us_{};                     // total time passed to tick(), in microseconds
 
   /* Retransmission timer management */
   uint64_t initial_RTO_ms_;                 // initial RTO in milliseconds
   uint64_t current_RTO_ms_{};                // current RTO in milliseconds             
-  uint64_t timer_{};                        // timer for retransmission
+  uint64_t timer_us_{};                     // timer for retransmission (microseconds)
   bool timer_running_{};                   // is the timer running?
   uint64_t consecutive_retransmissions_{}; // number of consecutive retransmissions
+  bool adaptive_rto_{};                    // use rtt_'s RTO instead of initial_RTO_ms_?
+  uint64_t max_RTO_ms_;                    // largest adaptive RTO, even after backoff
+  RTTEstimator rtt_;                       // estimates from round-trip times measured on acks
+
+  // outstanding segments waiting for acknowledgment, in sequence order (the SACK "scoreboard"). Each keeps its own
+  // payload, which is lent to segment_ for every transmission of it.
+  struct Outstanding
+  {
+    uint64_t seqno;                  // absolute sequence number of the segment's first byte
+    uint64_t length;                 // how many sequence numbers it uses
+    bool SYN {};                     // does it carry the SYN (and the options that go with it)?
+    bool FIN {};                     // does it carry the FIN?
+    std::optional<uint64_t> sent_us; // when it was sent, unless it has been resent since (Karn's rule)
+    bool sacked {};                  // has the peer selectively acknowledged it?
+    bool retransmitted {};           // has it been resent because SACKs or duplicate acks showed it lost?
+    bool lost {};                    // have SACKs shown it lost (RFC 6675's IsLost())?
+    std::string payload {};          // its bytes, copied once from the input stream
+
+    uint64_t lost_length() const { return lost && !retransmitted && !sacked ? length : 0; } // (in lost_bytes_)
+  };
+  std::deque<Outstanding> outstanding_messages_{};
+  std::vector<std::string> spare_payloads_{}; // payloads of acked segments, to reuse (at most a window's worth)
+  TCPSenderMessage segment_{};                 // the segment being transmitted (reused for its options)
 
-  // outstanding segments waiting for acknowledgment
-  std::queue<TCPSenderMessage> outstanding_messages_{};
+  uint64_t pipe() const;            // bytes that may still be in the network
+  uint64_t congestion_room() const; // how many more bytes the congestion window lets us send now
+  void enter_recovery();            // react to a loss detected by SACKs or duplicate acks
+  void stamp( TCPSenderMessage& msg ) const; // set the timestamp option (if in use) to the current time
+  bool hold_small_segment() const;           // should a segment that empties the stream wait to grow?
+  void pace( uint64_t bytes );               // schedule the next release after a segment of `bytes` bytes
+  void send( Outstanding& segment, const TransmitFunction& transmit ); // transmit an outstanding segment
+  void mark( Outstanding& segment, bool Outstanding::*flag ); // set a flag, keeping lost_bytes_ in step
+  std::deque<Outstanding>::iterator find_segment( uint64_t seqno ); // first outstanding segment from `seqno` on
+  void mark_sacked( const TCPReceiverMessage& msg );
+  void retransmit_lost( const TransmitFunction& transmit );
 };
\ No newline at end of file
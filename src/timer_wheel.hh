@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+ * TimerWheel: a timer for each of many keys, each set to go off at a deadline (in milliseconds), where letting
+ * time pass only touches the timers that go off, not every key that has one.
+ *
+ * It is a hierarchical timing wheel (Varghese and Lauck): LEVELS rings of SLOTS slots each, where level 0's
+ * slots are a millisecond apart, level 1's are SLOTS milliseconds apart, and so on. A timer is kept in the slot
+ * for its deadline on the finest level whose ring reaches that far. When the clock reaches a slot on a coarser
+ * level, its timers move down ("cascade") to finer slots. Setting, resetting and cancelling a timer are O(1).
+ */
+template<class Key>
+class TimerWheel
+{
+public:
+  static constexpr unsigned SLOT_BITS = 6;
+  static constexpr uint64_t SLOTS = uint64_t { 1 } << SLOT_BITS; // slots per level
+  static constexpr unsigned LEVELS = 4; // (reaching 2^24 ms, about four and a half hours, ahead)
+  static constexpr uint64_t SPAN = uint64_t { 1 } << ( SLOT_BITS * LEVELS );
+
+  explicit TimerWheel( uint64_t now_ms = 0 ) : now_ms_( now_ms ) { heads_.fill( NONE ); }
+
+  // Set the timer for `key` to go off at `deadline_ms`, replacing any deadline it had. (A deadline that has
+  // already passed goes off at the start of the next advance(), even one called from `expire`.)
+  void schedule( const Key& key, uint64_t deadline_ms )
+  {
+    const auto [it, added] = index_.try_emplace( key, NONE );
+    if ( added ) {
+      it->second = allocate( key );
+    } else if ( nodes_[it->second].deadline == deadline_ms ) {
+      return;
+    } else {
+      unlink( it->second );
+    }
+    nodes_[it->second].deadline = deadline_ms;
+    place( it->second );
+  }
+
+  // Stop the timer for `key`, if it is set
+  void cancel( const Key& key )
+  {
+    const auto it = index_.find( key );
+    if ( it != index_.end() ) {
+      unlink( it->second );
+      free_.push_back( it->second );
+      index_.erase( it );
+    }
+  }
+
+  // When the timer for `key` goes off (if it is set)
+  std::optional<uint64_t> deadline( const Key& key ) const
+  {
+    const auto it = index_.find( key );
+    if ( it == index_.end() ) {
+      return {};
+    }
+    return nodes_[it->second].deadline;
+  }
+
+  // Move the clock forward to `now_ms`, calling `expire( key )` for each timer that goes off along the way, in
+  // the millisecond it is due. A timer is cancelled before it goes off, so `expire` may set it again, or set or
+  // cancel any other.
+  template<class ExpireFunction>
+  void advance( uint64_t now_ms, ExpireFunction&& expire )
+  {
+    // What was set for a deadline that had already passed
+    collect( DUE );
+    fire( expire );
+
+    while ( now_ms_ < now_ms ) {
+      if ( index_.empty() ) {
+        now_ms_ = now_ms;
+        break;
+      }
+
+      // While the finer levels are empty, nothing can happen until the clock reaches a slot on a coarser one
+      unsigned empty_levels = 0;
+      while ( empty_levels < LEVELS - 1 and counts_[empty_levels] == 0 ) {
+        empty_levels++;
+      }
+      const unsigned shift = SLOT_BITS * empty_levels;
+      const uint64_t next_slot = ( ( now_ms_ >> shift ) + 1 ) << shift;
+      now_ms_ = std::min( next_slot, now_ms + 1 ) - 1;
+      if ( now_ms_ == now_ms ) {
+        break;
+      }
+      now_ms_++;
+
+      // Bring down the timers on coarser levels whose slot the clock has reached (coarsest first, so that
+      // theirs cascade all the way), and then fire level 0's slot for this millisecond
+      for ( unsigned level = LEVELS - 1; level > 0; level-- ) {
+        if ( ( now_ms_ & ( ( uint64_t { 1 } << ( SLOT_BITS * level ) ) - 1 ) ) == 0 ) {
+          cascade( slot( level, now_ms_ ) );
+        }
+      }
+      collect( slot( 0, now_ms_ ) );
+      fire( expire );
+    }
+  }
+
+  // The earliest time at which advance() has anything to do: set off a timer, or move timers down from a slot
+  // on a coarser level. No timer goes off before then. (There is no value if no timer is set.)
+  std::optional<uint64_t> next_event() const
+  {
+    if ( index_.empty() ) {
+      return {};
+    }
+    if ( heads_[DUE] != NONE ) {
+      return now_ms_;
+    }
+    uint64_t earliest = UINT64_MAX;
+    for ( unsigned level = 0; level < LEVELS; level++ ) {
+      const unsigned shift = SLOT_BITS * level;
+      for ( uint64_t step = 1; counts_[level] > 0 and step <= SLOTS; step++ ) {
+        const uint64_t when = ( ( now_ms_ >> shift ) + step ) << shift;
+        if ( heads_[slot( level, when )] != NONE ) {
+          earliest = std::min( earliest, when );
+          break;
+        }
+      }
+    }
+    return earliest;
+  }
+
+  uint64_t now() const { return now_ms_; }
+  size_t size() const { return index_.size(); }
+  bool empty() const { return index_.empty(); }
+
+private:
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  // A list of timers in one slot (or one of the two lists after the slots)
+  static constexpr uint32_t DUE = LEVELS * SLOTS;   // set for a deadline that had already passed
+  static constexpr uint32_t FIRING = DUE + 1;       // going off in the advance() under way
+  static constexpr uint32_t LISTS = FIRING + 1;
+
+  // A timer, in a doubly linked list of the others in its slot
+  struct Node
+  {
+    Key key;
+    uint64_t deadline {};
+    uint32_t list { NONE };
+    uint32_t prev { NONE };
+    uint32_t next { NONE };
+  };
+
+  uint64_t now_ms_;
+  std::vector<Node> nodes_ {};
+  std::vector<uint32_t> free_ {}; // nodes that can be reused
+  std::unordered_map<Key, uint32_t> index_ {};
+  std::array<uint32_t, LISTS> heads_ {};
+  std::array<size_t, LEVELS> counts_ {}; // timers on each level
+
+  static uint32_t slot( unsigned level, uint64_t time )
+  {
+    return static_cast<uint32_t>( level * SLOTS + ( ( time >> ( SLOT_BITS * level ) ) & ( SLOTS - 1 ) ) );
+  }
+
+  uint32_t allocate( const Key& key )
+  {
+    if ( free_.empty() ) {
+      nodes_.push_back( Node { .key = key } );
+      return static_cast<uint32_t>( nodes_.size() - 1 );
+    }
+    const uint32_t node = free_.back();
+    free_.pop_back();
+    nodes_[node].key = key;
+    return node;
+  }
+
+  void link( uint32_t node, uint32_t list )
+  {
+    Node& n = nodes_[node];
+    if ( list < DUE ) {
+      counts_[list / SLOTS]++;
+    }
+    n.list = list;
+    n.prev = NONE;
+    n.next = heads_[list];
+    if ( n.next != NONE ) {
+      nodes_[n.next].prev = node;
+    }
+    heads_[list] = node;
+  }
+
+  void unlink( uint32_t node )
+  {
+    const Node& n = nodes_[node];
+    if ( n.list < DUE ) {
+      counts_[n.list / SLOTS]--;
+    }
+    ( n.prev == NONE ? heads_[n.list] : nodes_[n.prev].next ) = n.next;
+    if ( n.next != NONE ) {
+      nodes_[n.next].prev = n.prev;
+    }
+  }
+
+  // Put a timer in the slot for its deadline, on the finest level that reaches it. A slot on level L is reached
+  // at a multiple of SLOTS^L ms, which is after now (as the timer is at least that far off) and no later than
+  // the deadline. Beyond the coarsest level's reach, it waits in the farthest slot and cascades back into it.
+  void place( uint32_t node )
+  {
+    const uint64_t deadline = nodes_[node].deadline;
+    if ( deadline <= now_ms_ ) {
+      link( node, DUE );
+      return;
+    }
+    const uint64_t when = std::min( deadline, now_ms_ + SPAN - 1 );
+    unsigned level = 0;
+    while ( when - now_ms_ >= uint64_t { 1 } << ( SLOT_BITS * ( level + 1 ) ) ) {
+      level++;
+    }
+    link( node, slot( level, when ) );
+  }
+
+  // Move the timers of a slot that the clock has reached to where they now belong (or set them off, if due now)
+  void cascade( uint32_t list )
+  {
+    uint32_t node = std::exchange( heads_[list], NONE );
+    while ( node != NONE ) {
+      const uint32_t next = nodes_[node].next;
+      counts_[list / SLOTS]--;
+      if ( nodes_[node].deadline <= now_ms_ ) {
+        link( node, FIRING );
+      } else {
+        place( node );
+      }
+      node = next;
+    }
+  }
+
+  // Add a list's timers to the ones about to go off
+  void collect( uint32_t list )
+  {
+    uint32_t node = std::exchange( heads_[list], NONE );
+    while ( node != NONE ) {
+      const uint32_t next = nodes_[node].next;
+      if ( list < DUE ) {
+        counts_[list / SLOTS]--;
+      }
+      link( node, FIRING );
+      node = next;
+    }
+  }
+
+  // Set off the timers that are going off, one at a time (each expire() may cancel others)
+  template<class ExpireFunction>
+  void fire( ExpireFunction& expire )
+  {
+    while ( heads_[FIRING] != NONE ) {
+      const uint32_t node = heads_[FIRING];
+      unlink( node );
+      const Key key = nodes_[node].key; // (the node may be reused by expire())
+      index_.erase( key );
+      free_.push_back( node );
+      expire( key );
+    }
+  }
+};
@@ -0,0 +1,133 @@
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+void reserve_tests( ByteStream::Storage storage )
+{
+  {
+    ByteStreamTestHarness test { "reserve-commit", 15, storage };
+    test.execute( Reserve { "hello" } );
+    test.execute( BytesPushed { 0 } );
+    test.execute( BufferEmpty { true } );
+    test.execute( Commit { 5 } );
+    test.execute( BytesPushed { 5 } );
+    test.execute( AvailableCapacity { 10 } );
+    test.execute( Peek { "hello" } );
+  }
+
+  {
+    ByteStreamTestHarness test { "partial commit", 15, storage };
+    test.execute( Reserve { "catdog" } );
+    test.execute( Commit { 3 } );
+    test.execute( BytesPushed { 3 } );
+    test.execute( AvailableCapacity { 12 } );
+    test.execute( Commit { 3 } );
+    test.execute( BytesPushed { 3 } );
+    test.execute( Peek { "cat" } );
+  }
+
+  {
+    ByteStreamTestHarness test { "commit more than reserved", 15, storage };
+    test.execute( Reserve { "ab" } );
+    test.execute( Commit { 10 } );
+    test.execute( BytesPushed { 2 } );
+    test.execute( Peek { "ab" } );
+  }
+
+  {
+    ByteStreamTestHarness test { "reserve up to capacity", 4, storage };
+    test.execute( Reserve { "abcd" } );
+    test.execute( Commit { 4 } );
+    test.execute( AvailableCapacity { 0 } );
+    test.execute( Reserve { "" } );
+    test.execute( Commit { 1 } );
+    test.execute( BytesPushed { 4 } );
+    test.execute( Peek { "abcd" } );
+  }
+
+  {
+    ByteStreamTestHarness test { "interleave with push", 15, storage };
+    test.execute( Push { "ab" } );
+    test.execute( Reserve { "cd" } );
+    test.execute( Commit { 2 } );
+    test.execute( Push { "ef" } );
+    test.execute( Reserve { "gh" } );
+    test.execute( Push { "ij" } );
+    test.execute( Commit { 2 } );
+    test.execute( BytesPushed { 8 } );
+    test.execute( Peek { "abcdefij" } );
+  }
+
+  {
+    ByteStreamTestHarness test { "small commits of a large reservation", 15, storage };
+    test.execute( Reserve { "abcdefghij" } );
+    test.execute( Commit { 2 } );
+    test.execute( Reserve { "cdefghijkl" } );
+    test.execute( Commit { 1 } );
+    test.execute( Reserve { "xy" } );
+    test.execute( Commit { 2 } );
+    test.execute( BytesPushed { 5 } );
+    test.execute( Peek { "abcxy" } );
+  }
+
+  {
+    ByteStreamTestHarness test { "pop while reserved", 15, storage };
+    test.execute( Push { "ab" } );
+    test.execute( Reserve { "cd" } );
+    test.execute( Pop { 2 } );
+    test.execute( BufferEmpty { true } );
+    test.execute( Commit { 2 } );
+    test.execute( BytesPopped { 2 } );
+    test.execute( Peek { "cd" } );
+  }
+
+  {
+    ByteStreamTestHarness test { "reserve across wraparound", 8, storage };
+    test.execute( Push { "abcdef" } );
+    test.execute( Pop { 4 } );
+    test.execute( Reserve { "gh" } );
+    test.execute( Commit { 2 } );
+    test.execute( Reserve { "ijkl" } );
+    test.execute( Commit { 4 } );
+    test.execute( AvailableCapacity { 0 } );
+    test.execute( Peek { "efghijkl" } );
+  }
+
+  // (the ring starts out at 4096 bytes here, far below the capacity)
+  if ( storage == ByteStream::Storage::Ring ) {
+    ByteStreamTestHarness test { "reserve while a partly grown ring has wrapped", 1 << 20, storage };
+    test.execute( Push { string( 4096, 'a' ) } );
+    test.execute( Pop { 3000 } );
+    test.execute( Push { string( 1000, 'b' ) } );
+    test.execute( Fill { 100000, 'c' } );
+    test.execute( BytesBuffered { 4096 } );
+    test.execute( ReadAll { string( 1096, 'a' ) + string( 1000, 'b' ) + string( 2000, 'c' ) } );
+  }
+
+  {
+    ByteStreamTestHarness test { "commit after close", 15, storage };
+    test.execute( Reserve { "abc" } );
+    test.execute( Close {} );
+    test.execute( Commit { 3 } );
+    test.execute( BytesPushed { 0 } );
+    test.execute( IsFinished { true } );
+  }
+}
+
+int main()
+{
+  try {
+    reserve_tests( ByteStream::Storage::Ring );
+    reserve_tests( ByteStream::Storage::Chunks );
+    reserve_tests( ByteStream::Storage::Mirrored );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -16,7 +16,8 @@ double speed_test( fstream& debug_output,
                    const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
                    const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
                    const size_t write_size,  // NOLINT(bugprone-easily-swappable-parameters)
-                   const size_t read_size )  // NOLINT(bugprone-easily-swappable-parameters)
+                   const size_t read_size,   // NOLINT(bugprone-easily-swappable-parameters)
+                   const ByteStream::Storage storage = ByteStream::Storage::Ring )
 {
   // Generate the data to be written
   const string data = [&random_seed, &input_len] {
@@ -35,7 +36,7 @@ double speed_test( fstream& debug_output,
     split_data.emplace( data.substr( i, write_size ) );
   }
 
-  ByteStream bs { capacity };
+  ByteStream bs { capacity, storage };
   string output_data;
   output_data.reserve( data.size() );
 
@@ -73,13 +74,17 @@ double speed_test( fstream& debug_output,
   auto bits_per_second = 8 * bytes_per_second;
   auto gigabits_per_second = bits_per_second / 1e9;
 
-  cout << "ByteStream with capacity=" << capacity << ", write_size=" << write_size << ", read_size=" << read_size
-       << " reached " << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
+  const string storage_name = storage == ByteStream::Storage::Chunks     ? " (chunks)"
+                              : storage == ByteStream::Storage::Mirrored ? " (mirrored)"
+                                                                         : "";
+  cout << "ByteStream" << storage_name << " with capacity=" << capacity << ", write_size=" << write_size
+       << ", read_size=" << read_size << " reached " << fixed << setprecision( 2 ) << gigabits_per_second
+       << " Gbit/s.\n";
 
   auto read_s = to_string( read_size );
   const string fill( 5 - read_s.size(), ' ' );
-  debug_output << "        ByteStream throughput (pop length " << read_s << "):" << fill << fixed
-               << setprecision( 2 ) << setw( 5 ) << gigabits_per_second << " Gbit/s\n";
+  debug_output << "        ByteStream" << storage_name << " throughput (pop length " << read_s << "):" << fill
+               << fixed << setprecision( 2 ) << setw( 5 ) << gigabits_per_second << " Gbit/s\n";
 
   if ( gigabits_per_second < 0.1 ) {
     throw runtime_error( "ByteStream did not meet minimum speed of 0.1 Gbit/s" );
@@ -96,6 +101,13 @@ void program_body()
   speed_test( debug_output, 1e7, 32768, 789, 1500, 4096 );
   speed_test( debug_output, 1e7, 32768, 789, 1500, 128 );
   speed_test( debug_output, 1e7, 32768, 789, 1500, 32 );
+
+  speed_test( debug_output, 1e7, 32768, 789, 1500, 4096, ByteStream::Storage::Chunks );
+  speed_test( debug_output, 1e7, 32768, 789, 1500, 128, ByteStream::Storage::Chunks );
+
+  speed_test( debug_output, 1e7, 32768, 789, 1500, 4096, ByteStream::Storage::Mirrored );
+  speed_test( debug_output, 1e7, 32768, 789, 1500, 128, ByteStream::Storage::Mirrored );
+  speed_test( debug_output, 1e8, 4194304, 789, 65536, 65536, ByteStream::Storage::Mirrored );
 }
 
 int main()
@@ -4,6 +4,7 @@
 #include "common.hh"
 #include "helpers.hh"
 
+#include <algorithm>
 #include <utility>
 
 static_assert( sizeof( Reader ) == sizeof( ByteStream ),
@@ -15,8 +16,15 @@ static_assert( sizeof( Writer ) == sizeof( ByteStream ),
 class ByteStreamTestHarness : public TestHarness<ByteStream>
 {
 public:
-  ByteStreamTestHarness( std::string test_name, uint64_t capacity )
-    : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity } )
+  ByteStreamTestHarness( std::string test_name,
+                         uint64_t capacity,
+                         ByteStream::Storage storage = ByteStream::Storage::Ring )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity )
+                     + ( storage == ByteStream::Storage::Chunks     ? ", storage=chunks"
+                         : storage == ByteStream::Storage::Mirrored ? ", storage=mirrored"
+                                                                    : "" ),
+                   ByteStream { capacity, storage } )
   {}
 
   size_t peek_size() { return object().reader().peek().size(); }
@@ -34,6 +42,56 @@ struct Push : public Action<ByteStream>
   constexpr std::string obj() const override { return "Writer"; }
 };
 
+struct Reserve : public Action<ByteStream>
+{
+  std::string data_;
+
+  explicit Reserve( std::string data ) : data_( move( data ) ) {}
+  std::string description() const override
+  {
+    return "reserve( " + std::to_string( data_.size() ) + " ) and write \"" + pretty_print( data_ ) + "\" there";
+  }
+  void execute( ByteStream& bs ) const override
+  {
+    const auto space = bs.writer().reserve( data_.size() );
+    if ( space.size() < data_.size() ) {
+      throw ExpectationViolation { "reserve( " + std::to_string( data_.size() ) + " ) returned only "
+                                   + std::to_string( space.size() ) + " bytes" };
+    }
+    data_.copy( space.data(), data_.size() );
+  }
+  constexpr std::string obj() const override { return "Writer"; }
+};
+
+struct Fill : public Action<ByteStream>
+{
+  size_t len_;
+  char c_;
+
+  Fill( size_t len, char c ) : len_( len ), c_( c ) {}
+  std::string description() const override
+  {
+    return "reserve( " + std::to_string( len_ ) + " ), fill all the space returned with '" + c_ + "' and commit it";
+  }
+  void execute( ByteStream& bs ) const override
+  {
+    const auto space = bs.writer().reserve( len_ );
+    std::fill( space.begin(), space.end(), c_ );
+    bs.writer().commit( space.size() );
+  }
+  constexpr std::string obj() const override { return "Writer"; }
+};
+
+struct Commit : public Action<ByteStream>
+{
+  size_t len_;
+
+  explicit Commit( size_t len ) : len_( len ) {}
+  std::string description() const override { return "commit( " + std::to_string( len_ ) + " )"; }
+  void execute( ByteStream& bs ) const override { bs.writer().commit( len_ ); }
+  constexpr std::string obj() const override { return "Writer"; }
+};
+
 struct Close : public Action<ByteStream>
 {
   std::string description() const override { return "close"; }
@@ -119,6 +177,31 @@ struct PeekOnce : public Peek
   }
 };
 
+struct PeekAll : public Peek
+{
+  using Peek::Peek;
+
+  std::string description() const override
+  {
+    return "peek_all() views together give \"" + pretty_print( output_ ) + "\"";
+  }
+
+  void execute( const ByteStream& bs ) const override
+  {
+    std::string got;
+    for ( const auto view : bs.reader().peek_all() ) {
+      if ( view.empty() ) {
+        throw ExpectationViolation { "peek_all() method returned an empty string_view" };
+      }
+      got += view;
+    }
+    if ( got != output_ ) {
+      throw ExpectationViolation { "peek_all() should have returned \"" + pretty_print( output_ )
+                                   + "\", but instead returned \"" + pretty_print( got ) + "\"" };
+    }
+  }
+};
+
 struct IsClosed : public ExpectBool<ByteStream>
 {
   using ExpectBool::ExpectBool;
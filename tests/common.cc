@@ -80,6 +80,18 @@ string to_string( const TCPSenderMessage& msg )
   if ( msg.SYN ) {
     o << " +SYN";
   }
+  if ( msg.mss.has_value() ) {
+    o << " MSS=" << *msg.mss;
+  }
+  if ( msg.window_scale.has_value() ) {
+    o << " +WSCALE=" << +*msg.window_scale;
+  }
+  if ( msg.SACK_permitted ) {
+    o << " +SACK_PERM";
+  }
+  if ( msg.timestamp.has_value() ) {
+    o << " TSval=" << *msg.timestamp;
+  }
   if ( not msg.payload.empty() ) {
     o << " payload=\"" << pretty_print( msg.payload ) << "\"";
   }
@@ -6,6 +6,7 @@
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 // https://stackoverflow.com/questions/33399594/making-a-user-defined-class-stdto-stringable
 
@@ -42,6 +43,16 @@ inline std::string to_string( const std::string& str )
 {
   return pretty_print( str );
 }
+
+template<typename T>
+std::string to_string( const std::vector<std::pair<T, T>>& ranges )
+{
+  std::string ret = "[";
+  for ( const auto& [begin, end] : ranges ) {
+    ret += ( ret.size() > 1 ? ", " : "" ) + to_string( begin ) + "-" + to_string( end );
+  }
+  return ret + "]";
+}
 } // namespace minnow_conversions
 
 template<typename T>
@@ -130,6 +130,36 @@ int main()
       test.execute( ReadAll( "" ) );
       test.execute( IsFinished { true } );
     }
+
+    {
+      ReassemblerTestHarness test { "holes 8 (bytes past the last substring)", 65000 };
+
+      test.execute( Insert { "0123456789", 10 } );
+      test.execute( BytesPending( 10 ) );
+
+      test.execute( Insert { "abcde", 0 }.is_last() );
+      test.execute( BytesPushed( 5 ) );
+      test.execute( ReadAll( "abcde" ) );
+      test.execute( BytesPending( 0 ) );
+      test.execute( IsFinished { true } );
+
+      test.execute( Insert { "fghij", 5 } );
+      test.execute( BytesPushed( 5 ) );
+      test.execute( ReadAll( "" ) );
+      test.execute( BytesPending( 0 ) );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ReassemblerTestHarness test { "holes 9 (pending bytes straddling the end)", 65000 };
+
+      test.execute( Insert { "cdef", 2 } );
+      test.execute( Insert { "abc", 0 }.is_last() );
+      test.execute( BytesPushed( 3 ) );
+      test.execute( ReadAll( "abc" ) );
+      test.execute( BytesPending( 0 ) );
+      test.execute( IsFinished { true } );
+    }
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << "\n";
     return EXIT_FAILURE;
@@ -43,6 +43,15 @@ public:
                    { TCPReceiver { Reassembler { ByteStream { capacity } } } } )
   {}
 
+  TCPReceiverTestHarness( std::string test_name, const TCPConfig& config )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( config.recv_capacity )
+                     + ( config.window_scaling ? ", window scaling" : "" )
+                     + ( config.timestamps ? ", timestamps" : "" )
+                     + ( config.sws_avoidance ? ", SWS avoidance" : "" ),
+                   { TCPReceiver { Reassembler { ByteStream { config.recv_capacity } }, config } } )
+  {}
+
   template<std::derived_from<TestStep<Reassembler>> T>
   void execute( const T& test )
   {
@@ -80,6 +89,20 @@ struct ExpectReset : public ExpectBool<TCPReceiver>
   bool value( const TCPReceiver& rs ) const override { return rs.send().RST; }
 };
 
+struct ExpectSack : public ExpectNumber<TCPReceiver, std::vector<std::pair<Wrap32, Wrap32>>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "SACK blocks"; }
+  std::vector<std::pair<Wrap32, Wrap32>> value( const TCPReceiver& rs ) const override { return rs.send().sack; }
+};
+
+struct ExpectTimestampEcho : public ExpectNumber<TCPReceiver, std::optional<uint32_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "timestamp echo"; }
+  std::optional<uint32_t> value( const TCPReceiver& rs ) const override { return rs.send().timestamp_echo; }
+};
+
 struct ExpectAcknoBetween : public Expectation<TCPReceiver>
 {
   Wrap32 isn_;
@@ -138,6 +161,24 @@ struct SegmentArrives : public Action<TCPReceiver>
     return *this;
   }
 
+  SegmentArrives& with_sack_permitted()
+  {
+    msg_.SACK_permitted = true;
+    return *this;
+  }
+
+  SegmentArrives& with_window_scale( uint8_t scale )
+  {
+    msg_.window_scale = scale;
+    return *this;
+  }
+
+  SegmentArrives& with_timestamp( uint32_t timestamp )
+  {
+    msg_.timestamp = timestamp;
+    return *this;
+  }
+
   SegmentArrives& with_seqno( Wrap32 seqno_ )
   {
     msg_.seqno = seqno_;
@@ -161,6 +202,7 @@ struct SegmentArrives : public Action<TCPReceiver>
   void execute( TCPReceiver& rs ) const override
   {
     rs.receive( msg_ );
+    rs.note_ack_sent( rs.send() ); // (each segment is acked as it arrives)
     ackno_expected_.execute( rs );
   }
 
@@ -0,0 +1,84 @@
+#include "byte_stream_test_harness.hh"
+#include "random.hh"
+#include "reassembler_test_harness.hh"
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "no SACK blocks unless permitted", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 10 ).with_data( "abcd" ) );
+      test.execute( BytesPending { 4 } );
+      test.execute( ExpectSack { {} } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "one hole", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_seqno( isn ) );
+      test.execute( ExpectSack { {} } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 10 ).with_data( "abcd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSack { { { Wrap32 { isn + 10 }, Wrap32 { isn + 14 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "012345678" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 14 } } );
+      test.execute( ExpectSack { {} } );
+      test.execute( ReadAll { "012345678abcd" } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "most recent block first", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 21 ).with_data( "u" ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 11 ).with_data( "k" ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 31 ).with_data( "E" ) );
+      test.execute( ExpectSack { { { Wrap32 { isn + 31 }, Wrap32 { isn + 32 } },
+                                   { Wrap32 { isn + 11 }, Wrap32 { isn + 12 } },
+                                   { Wrap32 { isn + 21 }, Wrap32 { isn + 22 } } } } );
+
+      // extending a block makes it the most recent
+      test.execute( SegmentArrives {}.with_seqno( isn + 22 ).with_data( "v" ) );
+      test.execute( ExpectSack { { { Wrap32 { isn + 21 }, Wrap32 { isn + 23 } },
+                                   { Wrap32 { isn + 31 }, Wrap32 { isn + 32 } },
+                                   { Wrap32 { isn + 11 }, Wrap32 { isn + 12 } } } } );
+
+      // filling a hole merges two blocks
+      test.execute( SegmentArrives {}.with_seqno( isn + 12 ).with_data( "lmnopqrst" ) );
+      test.execute( ExpectSack { { { Wrap32 { isn + 11 }, Wrap32 { isn + 23 } },
+                                   { Wrap32 { isn + 31 }, Wrap32 { isn + 32 } } } } );
+      test.execute( BytesPending { 13 } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "at most four blocks", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_seqno( isn ) );
+      for ( uint32_t i = 1; i <= 6; i++ ) {
+        test.execute( SegmentArrives {}.with_seqno( isn + 1 + 10 * i ).with_data( "x" ) );
+      }
+      test.execute( ExpectSack { { { Wrap32 { isn + 61 }, Wrap32 { isn + 62 } },
+                                   { Wrap32 { isn + 51 }, Wrap32 { isn + 52 } },
+                                   { Wrap32 { isn + 41 }, Wrap32 { isn + 42 } },
+                                   { Wrap32 { isn + 31 }, Wrap32 { isn + 32 } } } } );
+      test.execute( BytesPending { 6 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+#include "byte_stream_test_harness.hh"
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      TCPConfig cfg;
+      cfg.recv_capacity = 4000;
+      cfg.sws_avoidance = true;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "Freed space is offered a full segment at a time", cfg };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectWindow { 4000 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 3000, 'x' ) ) );
+      test.execute( ExpectWindow { 1000 } );
+      test.execute( Pop { 10 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3001 ).with_data( string( 10, 'y' ) ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 3011 } } );
+      test.execute( ExpectWindow { 990 } );
+      test.execute( Pop { 980 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3011 ) );
+      test.execute( ExpectWindow { 990 } );
+      test.execute( Pop { 20 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3011 ) );
+      test.execute( ExpectWindow { 2000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.recv_capacity = 1000;
+      cfg.mss = 1460;
+      cfg.sws_avoidance = true;
+      const uint32_t isn = 893;
+      TCPReceiverTestHarness test { "A small buffer offers half of itself at a time", cfg };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 1000, 'x' ) ) );
+      test.execute( ExpectWindow { 0 } );
+      test.execute( Pop { 499 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1001 ) );
+      test.execute( ExpectWindow { 0 } );
+      test.execute( Pop { 1 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1001 ) );
+      test.execute( ExpectWindow { 500 } );
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.recv_capacity = 4000;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "Without SWS avoidance, every freed byte is offered", cfg };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 3000, 'x' ) ) );
+      test.execute( Pop { 10 } );
+      test.execute( ExpectWindow { 1010 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+#include "random.hh"
+#include "reassembler_test_harness.hh"
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPConfig cfg;
+      TCPReceiverTestHarness test { "no echo by default", cfg };
+      test.execute( SegmentArrives {}.with_syn().with_timestamp( 5 ).with_seqno( isn ) );
+      test.execute( ExpectTimestampEcho { nullopt } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPConfig cfg;
+      cfg.timestamps = true;
+      TCPReceiverTestHarness test { "no echo unless the peer's SYN has a timestamp", cfg };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ).with_timestamp( 5 ) );
+      test.execute( ExpectTimestampEcho { nullopt } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPConfig cfg;
+      cfg.timestamps = true;
+      TCPReceiverTestHarness test { "echo the segment that moved the ackno", cfg };
+      test.execute( ExpectTimestampEcho { nullopt } );
+      test.execute( SegmentArrives {}.with_syn().with_timestamp( 10 ).with_seqno( isn ) );
+      test.execute( ExpectTimestampEcho { 10 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ).with_timestamp( 20 ) );
+      test.execute( ExpectTimestampEcho { 20 } );
+
+      // out of order: keep echoing the last in-order segment
+      test.execute( SegmentArrives {}.with_seqno( isn + 7 ).with_data( "ghi" ).with_timestamp( 30 ) );
+      test.execute( BytesPending { 3 } );
+      test.execute( ExpectTimestampEcho { 20 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 4 ).with_data( "def" ).with_timestamp( 40 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 10 } } );
+      test.execute( ExpectTimestampEcho { 40 } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPConfig cfg;
+      cfg.timestamps = true;
+      TCPReceiverTestHarness test { "PAWS drops segments with old timestamps", cfg };
+      test.execute( SegmentArrives {}.with_syn().with_timestamp( 1000 ).with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ).with_timestamp( 2000 ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 4 ).with_data( "def" ).with_timestamp( 1500 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 4 } } );
+      test.execute( ExpectTimestampEcho { 2000 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 4 ).with_data( "def" ).with_timestamp( 2000 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 7 } } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPConfig cfg;
+      cfg.timestamps = true;
+      TCPReceiverTestHarness test { "timestamps compare across wraparound", cfg };
+      test.execute( SegmentArrives {}.with_syn().with_timestamp( UINT32_MAX - 10 ).with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ).with_timestamp( 20 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 4 } } );
+      test.execute( ExpectTimestampEcho { 20 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 4 ).with_data( "def" ).with_timestamp( UINT32_MAX ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 4 } } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
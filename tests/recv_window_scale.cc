@@ -0,0 +1,70 @@
+#include "byte_stream_test_harness.hh"
+#include "random.hh"
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPConfig cfg;
+      cfg.recv_capacity = 1'000'000;
+      TCPReceiverTestHarness test { "window isn't scaled by default", cfg };
+      test.execute( SegmentArrives {}.with_syn().with_window_scale( 7 ).with_seqno( isn ) );
+      test.execute( ExpectWindow { UINT16_MAX } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPConfig cfg;
+      cfg.recv_capacity = 1'000'000;
+      cfg.window_scaling = true;
+      TCPReceiverTestHarness test { "window isn't scaled unless the peer offers it", cfg };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectWindow { UINT16_MAX } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPConfig cfg;
+      cfg.recv_capacity = 1'000'000;
+      cfg.window_scaling = true;
+      TCPReceiverTestHarness test { "window is scaled once both ends offer it", cfg };
+      test.execute( ExpectWindow { UINT16_MAX } );
+      test.execute( SegmentArrives {}.with_syn().with_window_scale( 7 ).with_seqno( isn ) );
+      test.execute( ExpectWindow { 62500 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 160, 'x' ) ) );
+      test.execute( ExpectWindow { 62490 } );
+
+      // a window smaller than the scale rounds down
+      test.execute( SegmentArrives {}.with_seqno( isn + 161 ).with_data( string( 999'830, 'x' ) ) );
+      test.execute( ExpectWindow { 0 } );
+      test.execute( ReadAll { string( 999'990, 'x' ) } );
+      test.execute( ExpectWindow { 62500 } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPConfig cfg;
+      cfg.recv_capacity = 60'000;
+      cfg.window_scaling = true;
+      TCPReceiverTestHarness test { "small capacity needs no scale", cfg };
+      test.execute( SegmentArrives {}.with_syn().with_window_scale( 7 ).with_seqno( isn ) );
+      test.execute( ExpectWindow { 60000 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,188 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "No congestion window by default", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( ExpectCongestionWindow { UINT64_MAX } );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( unsigned i = 0; i < 10; i++ ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      }
+      test.execute( ExpectSeqnosInFlight { 10000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+      TCPSenderTestHarness test { "Slow start, then the loss window after an RTO", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( ExpectCongestionWindow { 4000 } );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( ExpectCongestionWindow { 4001 } );
+
+      // the congestion window, not the receiver's window, limits the flight
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( unsigned i = 0; i < 4; i++ ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 1000 * i ).with_payload_size( 1000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 4000 } );
+
+      // slow start: one more segment for each ack
+      test.execute( Receive { { isn + 2001, 20000 } } );
+      test.execute( ExpectCongestionWindow { 5001 } );
+      for ( unsigned i = 4; i < 7; i++ ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 1000 * i ).with_payload_size( 1000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 5000 } );
+
+      // timeout: back to one segment
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 2001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectCongestionWindow { 1000 } );
+      test.execute( Push {} );
+      test.execute( ExpectNoSegment {} );
+
+      test.execute( Receive { { isn + 7001, 20000 } } );
+      test.execute( ExpectCongestionWindow { 2000 } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 7001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 8001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+      TCPSenderTestHarness test { "Congestion avoidance grows one segment per window", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( Push { string( 4000, 'x' ) } );
+      test.execute( ExpectSeqnosInFlight { 4000 } );
+
+      // an RTO sets ssthresh to half the flight (2000), and the acks after it reach it
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectCongestionWindow { 1000 } );
+      test.execute( Receive { { isn + 1001, 20000 } } );
+      test.execute( ExpectCongestionWindow { 2000 } );
+      test.execute( Receive { { isn + 2001, 20000 } } );
+      test.execute( ExpectCongestionWindow { 2000 } );
+      test.execute( Receive { { isn + 3001, 20000 } } );
+      test.execute( ExpectCongestionWindow { 3000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.sack = true;
+      cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+      TCPSenderTestHarness test { "NewReno halves the window on a SACK-detected loss", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( unsigned i = 0; i < 4; i++ ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 1000 * i ).with_payload_size( 1000 ) );
+      }
+      test.execute( Receive { { isn + 1, 20000 } }.with_sack( isn + 1001, isn + 4001 ) );
+      test.execute( ExpectCongestionWindow { 2000 } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 4001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // no growth until the loss is repaired
+      test.execute( Receive { { isn + 4001, 20000 } } );
+      test.execute( ExpectCongestionWindow { 2000 } );
+      test.execute( Receive { { isn + 5001, 20000 } } );
+      test.execute( ExpectCongestionWindow { 2000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.sack = true;
+      cfg.congestion_control = CongestionControl::Algorithm::Cubic;
+
+      TCPSenderTestHarness test { "CUBIC reduces the window by 30% on a loss", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( ExpectCongestionWindow { 4001 } );
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( unsigned i = 0; i < 4; i++ ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 1000 * i ).with_payload_size( 1000 ) );
+      }
+      test.execute( Receive { { isn + 1, 20000 } }.with_sack( isn + 1001, isn + 4001 ) );
+      test.execute( ExpectCongestionWindow { 2800 } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 4001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion_control = CongestionControl::Algorithm::Cubic;
+
+      TCPSenderTestHarness test { "CUBIC only reduces once for repeated timeouts of a segment", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( Push { string( 4000, 'x' ) } );
+      for ( unsigned i = 0; i < 4; i++ ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 1000 * i ).with_payload_size( 1000 ) );
+      }
+
+      // the first timeout sets ssthresh to 70% of the window (2800); the backed-off second one leaves it there
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+      test.execute( ExpectCongestionWindow { 1000 } );
+      test.execute( Tick { 2UL * cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+      test.execute( ExpectCongestionWindow { 1000 } );
+
+      // so slow start carries the window past 2000
+      test.execute( Receive { { isn + 1001, 20000 } } );
+      test.execute( ExpectCongestionWindow { 2000 } );
+      test.execute( Receive { { isn + 2001, 20000 } } );
+      test.execute( ExpectCongestionWindow { 3000 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
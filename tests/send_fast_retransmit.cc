@@ -0,0 +1,138 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Duplicate acks are ignored by default", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( Push { string( 4000, 'x' ) } );
+      for ( unsigned i = 0; i < 4; i++ ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 1000 * i ).with_payload_size( 1000 ) );
+      }
+      for ( unsigned i = 0; i < 4; i++ ) {
+        test.execute( Receive { { isn + 1, 20000 } } );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "Third duplicate ack resends the hole, and so does a partial ack", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( Push { string( 6000, 'x' ) } );
+      for ( unsigned i = 0; i < 6; i++ ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 1000 * i ).with_payload_size( 1000 ) );
+      }
+
+      // the first two segments are lost
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( ExpectNoSegment {} );
+
+      // the repaired hole is acked, revealing the next one
+      test.execute( Receive { { isn + 1001, 20000 } } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Receive { { isn + 6001, 20000 } } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "Window updates are not duplicate acks", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( Push { string( 4000, 'x' ) } );
+      for ( unsigned i = 0; i < 4; i++ ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 1000 * i ).with_payload_size( 1000 ) );
+      }
+      test.execute( Receive { { isn + 1, 19000 } } );
+      test.execute( Receive { { isn + 1, 18000 } } );
+      test.execute( Receive { { isn + 1, 17000 } } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.fast_retransmit = true;
+      cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+      TCPSenderTestHarness test { "NewReno keeps the pipe full during fast recovery", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( unsigned i = 0; i < 4; i++ ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 1000 * i ).with_payload_size( 1000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+
+      // the first segment is lost: halve the window, resend it, and send one new segment for the 3 that arrived
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( ExpectCongestionWindow { 2000 } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 4001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // each further duplicate ack lets one more segment out
+      test.execute( Receive { { isn + 1, 20000 } } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 5001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // the repair is acked: recovery ends with the halved window
+      test.execute( Receive { { isn + 6001, 20000 } } );
+      test.execute( ExpectCongestionWindow { 2000 } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 6001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 7001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "SYN offers the default MSS", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_mss( TCPConfig::MAX_PAYLOAD_SIZE ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 5000 } } );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_mss( nullopt ).with_payload_size( 1000 ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.mss = TCPConfig::mss_for_mtu( 1500 );
+
+      TCPSenderTestHarness test { "Segments fill an Ethernet MTU", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_mss( 1460 ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 5000 } }.with_mss( 1460 ) );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 1460 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1461 ).with_payload_size( 1460 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 2921 ).with_payload_size( 80 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.mss = TCPConfig::mss_for_mtu( 9000 );
+
+      TCPSenderTestHarness test { "Peer's smaller MSS limits segments", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_mss( 8960 ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 5000 } }.with_mss( 536 ) );
+      test.execute( ExpectMaxPayloadSize { 536 } );
+      test.execute( Push { string( 1000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 536 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 537 ).with_payload_size( 464 ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.mss = TCPConfig::mss_for_mtu( 1500 );
+
+      TCPSenderTestHarness test { "Without an MSS option, the peer takes 536 bytes", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_mss( 1460 ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 5000 } }.without_mss() );
+      test.execute( ExpectMaxPayloadSize { TCPConfig::DEFAULT_MSS } );
+      test.execute( Push { string( 1000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 536 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 537 ).with_payload_size( 464 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "A tiny MSS from the peer is raised to the minimum", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 5000 } }.with_mss( 0 ).with_timestamp_echo( 0 ) );
+      test.execute( ExpectMaxPayloadSize { TCPConfig::MIN_MSS - TCPConfig::TIMESTAMPS_LENGTH } );
+      test.execute( Push { string( 100, 'x' ) } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 36 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 37 ).with_payload_size( 36 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 73 ).with_payload_size( 28 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.mss = TCPConfig::mss_for_mtu( 1500 );
+      cfg.timestamps = true;
+      cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+      TCPSenderTestHarness test { "Timestamps come out of the MSS, and cwnd counts in segments", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_mss( 1460 ).with_seqno( isn ) );
+      test.execute( ExpectCongestionWindow { 3 * 1460 } );
+      test.execute( Receive { { isn + 1, 20000 } }.with_mss( 1460 ).with_timestamp_echo( 0 ) );
+      test.execute( ExpectMaxPayloadSize { 1448 } );
+      test.execute( ExpectCongestionWindow { 3 * 1448 + 1 } ); // slow start credits the acknowledged SYN
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( unsigned i = 0; i < 3; i++ ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 1448 * i ).with_payload_size( 1448 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.nagle = true;
+
+      TCPSenderTestHarness test { "Nagle holds small writes while data is in flight", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) );
+      test.execute( Push { "a" } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_data( "a" ) );
+      test.execute( Push { "b" } );
+      test.execute( Push { "c" } );
+      test.execute( Push { "d" } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 2 } }.with_win( 10000 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 2 ).with_data( "bcd" ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.nagle = true;
+
+      TCPSenderTestHarness test { "Nagle sends full segments, and the end of the stream", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) );
+      test.execute( Push { string( 1500, 'x' ) } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push { string( 500, 'y' ) } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push { "z" }.with_close() );
+      test.execute( ExpectMessage {}.with_seqno( isn + 2001 ).with_data( "z" ).with_fin( true ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.cork = true;
+
+      TCPSenderTestHarness test { "Corking holds small writes until a flush", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) );
+      test.execute( Push { "GET / HTTP/1.1\r\n" } );
+      test.execute( Push { "Host: example.com\r\n" } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push { "\r\n" }.with_flush() );
+      test.execute(
+        ExpectMessage {}.with_seqno( isn + 1 ).with_data( "GET / HTTP/1.1\r\nHost: example.com\r\n\r\n" ) );
+      test.execute( Push { "more" } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push { string( 1000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 38 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( SetCork { false } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1038 ).with_payload_size( 4 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Without Nagle or corking, each write is sent", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) );
+      test.execute( Push { "a" } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_data( "a" ) );
+      test.execute( Push { "b" } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 2 ).with_data( "b" ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -198,6 +198,73 @@ int main()
       test.execute( ExpectSeqnosInFlight { 0 } );
       test.execute( HasError { false } );
     }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      const uint16_t retx_timeout = uniform_int_distribution<uint16_t> { 10, 10000 }( rd );
+      cfg.isn = isn;
+      cfg.rt_timeout = retx_timeout;
+
+      const string nicechars = "abcdefghijklmnopqrstuvwxyz";
+      string data;
+      for ( unsigned int i = 0; i < 5000; i++ ) {
+        data.push_back( nicechars.at( rd() % nicechars.size() ) );
+      }
+
+      TCPSenderTestHarness test { "Retransmit bytes that were sent after older ones were acked", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 3000 ) );
+      test.execute( Push { data.substr( 0, 3000 ) } );
+      for ( unsigned int i = 0; i < 3; i++ ) {
+        test.execute(
+          ExpectMessage {}.with_seqno( isn + 1 + 1000 * i ).with_data( data.substr( 1000 * i, 1000 ) ) );
+      }
+      test.execute( AckReceived { Wrap32 { isn + 2001 } }.with_win( 3000 ) );
+      test.execute( Push { data.substr( 3000 ) } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 3001 ).with_data( data.substr( 3000, 1000 ) ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 4001 ).with_data( data.substr( 4000, 1000 ) ) );
+      test.execute( AckReceived { Wrap32 { isn + 4001 } }.with_win( 3000 ) );
+      test.execute( ExpectSeqnosInFlight { 1000 } );
+      test.execute( Tick( retx_timeout ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 4001 ).with_data( data.substr( 4000, 1000 ) ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      const uint16_t retx_timeout = uniform_int_distribution<uint16_t> { 10, 10000 }( rd );
+      cfg.isn = isn;
+      cfg.rt_timeout = retx_timeout;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "A partial ack after a timeout resends the next hole", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 20000 ) );
+      test.execute( Push { string( 4000, 'x' ) } );
+      for ( unsigned i = 0; i < 4; i++ ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 1000 * i ).with_payload_size( 1000 ) );
+      }
+
+      // the first two segments are lost, and too few duplicate acks arrive for a fast retransmit
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 20000 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 20000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick( retx_timeout ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // the resent segment is acked, revealing the second hole, which goes out without waiting for the timer
+      test.execute( AckReceived { Wrap32 { isn + 1001 } }.with_win( 20000 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 4001 } }.with_win( 20000 ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectNoSegment {} );
+    }
   } catch ( const exception& e ) {
     cerr << e.what() << "\n";
     return 1;
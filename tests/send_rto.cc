@@ -0,0 +1,165 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "RTT is measured, but the RTO is fixed by default", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( ExpectRTO { cfg.rt_timeout } );
+      test.execute( Tick { 40 } );
+      test.execute( AckReceived { isn + 1 } );
+      test.execute( ExpectSRTT { 40 } );
+      test.execute( ExpectRTO { 200 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { cfg.rt_timeout - 1U } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.adaptive_rto = true;
+
+      TCPSenderTestHarness test { "RTO follows SRTT and RTTVAR", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { isn + 1 } );
+
+      // first sample: SRTT = 100, RTTVAR = 50, RTO = 100 + 4 * 50
+      test.execute( ExpectSRTT { 100 } );
+      test.execute( ExpectRTO { 300 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 299 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+
+      // exponential backoff still applies
+      test.execute( Tick { 599 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( ExpectConsecutiveRetransmissions { 2 } );
+
+      // Karn's rule: the ack of a retransmitted segment is no sample
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { isn + 4 } );
+      test.execute( ExpectSRTT { 100 } );
+      test.execute( ExpectRTO { 300 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+
+      // second sample: RTTVAR = 3/4 * 50 + 1/4 * |100 - 20| = 57.5, SRTT = 7/8 * 100 + 1/8 * 20 = 90
+      test.execute( Push { "def" } );
+      test.execute( ExpectMessage {}.with_data( "def" ) );
+      test.execute( Tick { 20 } );
+      test.execute( AckReceived { isn + 7 } );
+      test.execute( ExpectSRTT { 90 } );
+      test.execute( ExpectRTO { 320 } );
+
+      // the RTO restarts from the estimate after each ack
+      test.execute( Push { "ghi" } );
+      test.execute( ExpectMessage {}.with_data( "ghi" ) );
+      test.execute( Tick { 319 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "ghi" ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.adaptive_rto = true;
+
+      TCPSenderTestHarness test { "RTO has a lower bound", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Tick { 1 } );
+      test.execute( AckReceived { isn + 1 } );
+      test.execute( ExpectSRTT { 1 } );
+      test.execute( ExpectRTO { TCPConfig::MIN_RTO_MS } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { TCPConfig::MIN_RTO_MS } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.adaptive_rto = true;
+
+      TCPSenderTestHarness test { "RTTs below a millisecond are measured", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( TickUs { 200 } );
+      test.execute( AckReceived { isn + 1 } );
+      test.execute( ExpectSRTT { 0.2 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( TickUs { 600 } );
+      test.execute( AckReceived { isn + 4 } );
+      test.execute( ExpectSRTT { 0.25 } );
+      test.execute( ExpectRTO { TCPConfig::MIN_RTO_MS } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.adaptive_rto = true;
+      cfg.min_rto_ms = 1;
+      cfg.max_rto_ms = 4;
+
+      TCPSenderTestHarness test { "RTO bounds can be configured", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( TickUs { 200 } );
+      test.execute( AckReceived { isn + 1 } );
+      test.execute( ExpectRTO { 1 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+
+      // backoff stops at the ceiling
+      test.execute( Tick { 2 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 4 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 3 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
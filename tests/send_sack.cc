@@ -0,0 +1,178 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "SACK not offered by default", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_sack_permitted( false ).with_seqno( isn ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.sack = true;
+
+      TCPSenderTestHarness test { "SACK offered on SYN", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_sack_permitted( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_no_flags().with_sack_permitted( false ).with_data( "abc" ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.sack = true;
+
+      TCPSenderTestHarness test { "Holes below DUP_THRESH SACKed segments are resent", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      for ( const string segment : { "a", "b", "c", "d", "e" } ) {
+        test.execute( Push { segment } );
+        test.execute( ExpectMessage {}.with_data( segment ) );
+      }
+      test.execute( ExpectSeqnosInFlight { 5 } );
+
+      // "a" and "c" are missing
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_sack( isn + 2, isn + 3 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute(
+        AckReceived { Wrap32 { isn + 1 } }.with_sack( isn + 4, isn + 6 ).with_sack( isn + 2, isn + 3 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_data( "a" ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 5 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+
+      // "a" arrives, so the cumulative ack moves, but "c" only has two SACKed segments above it
+      test.execute( AckReceived { Wrap32 { isn + 3 } }.with_sack( isn + 4, isn + 6 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 3 } );
+
+      // each hole is only filled once per loss
+      test.execute( AckReceived { Wrap32 { isn + 3 } }.with_sack( isn + 4, isn + 6 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 6 } } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      const uint16_t retx_timeout = uniform_int_distribution<uint16_t> { 10, 10000 }( rd );
+      cfg.isn = isn;
+      cfg.rt_timeout = retx_timeout;
+      cfg.sack = true;
+
+      TCPSenderTestHarness test { "Several holes, then RTO lets them be repaired again", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      for ( const string segment : { "a", "b", "c", "d", "e", "f" } ) {
+        test.execute( Push { segment } );
+        test.execute( ExpectMessage {}.with_data( segment ) );
+      }
+
+      // "a" and "c" are missing
+      test.execute(
+        AckReceived { Wrap32 { isn + 1 } }.with_sack( isn + 4, isn + 7 ).with_sack( isn + 2, isn + 3 ) );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( ExpectMessage {}.with_data( "c" ) );
+      test.execute( ExpectNoSegment {} );
+
+      // the retransmissions are lost too
+      test.execute( Tick { retx_timeout } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectConsecutiveRetransmissions { 1 } );
+      test.execute( AckReceived { Wrap32 { isn + 3 } }.with_sack( isn + 4, isn + 7 ) );
+      test.execute( ExpectMessage {}.with_data( "c" ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.sack = true;
+      cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+      TCPSenderTestHarness test { "Holes are only resent as the congestion window allows", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 20000 } } );
+      for ( unsigned i = 0; i < 20; i++ ) {
+        test.execute( Push { string( 100, static_cast<char>( 'a' + i ) ) } );
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 100 * i ).with_payload_size( 100 ) );
+      }
+
+      // every other segment arrives: the first eight holes have three SACKed segments above them
+      Receive sacks { { isn + 1, 20000 } };
+      for ( unsigned i = 1; i < 20; i += 2 ) {
+        sacks.with_sack( isn + 1 + 100 * i, isn + 1 + 100 * ( i + 1 ) );
+      }
+      test.execute( sacks );
+      test.execute( ExpectCongestionWindow { 2000 } );
+      for ( unsigned i = 0; i < 16; i += 2 ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 100 * i ) );
+      }
+      test.execute( ExpectNoSegment {} );
+
+      // after a timeout, the loss window only has room for the front segment
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectCongestionWindow { 1000 } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ) );
+      test.execute( Push {} );
+      test.execute( ExpectNoSegment {} );
+
+      // as acks open the window, the other holes go out again one at a time
+      test.execute( Receive { { isn + 201, 20000 } } );
+      test.execute( ExpectCongestionWindow { 1200 } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 201 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "SACK blocks ignored unless enabled", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      for ( const string segment : { "a", "b", "c", "d" } ) {
+        test.execute( Push { segment } );
+        test.execute( ExpectMessage {}.with_data( segment ) );
+      }
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_sack( isn + 2, isn + 5 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
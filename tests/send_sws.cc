@@ -0,0 +1,80 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.sws_avoidance = true;
+
+      TCPSenderTestHarness test { "Wait for a useful window instead of sending a sliver", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 4000 ) );
+      test.execute( Push { string( 6000, 'x' ) } );
+      for ( unsigned i = 0; i < 4; i++ ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 1000 * i ).with_payload_size( 1000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 1001 } }.with_win( 3100 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 2001 } }.with_win( 3100 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 4001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 5001 } }.with_win( 100 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 5001 ).with_payload_size( 100 ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.sws_avoidance = true;
+
+      TCPSenderTestHarness test { "Half the largest window is worth sending", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1200 ) );
+      test.execute( Push { string( 500, 'x' ) } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 500 ) );
+      test.execute( Push { string( 3000, 'y' ) } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 501 ).with_payload_size( 700 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Without SWS avoidance, slivers are sent", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 4000 ) );
+      test.execute( Push { string( 6000, 'x' ) } );
+      for ( unsigned i = 0; i < 4; i++ ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 1000 * i ).with_payload_size( 1000 ) );
+      }
+      test.execute( AckReceived { Wrap32 { isn + 1001 } }.with_win( 3100 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 4001 ).with_payload_size( 100 ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,139 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "No timestamps by default", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( nullopt ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 1000 } }.with_timestamp_echo( 0 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( nullopt ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "Timestamps stop unless the peer's SYN has one too", cfg };
+      test.execute( Tick { 5 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 5 ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 1000 } } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( nullopt ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "A SYN-ACK offers timestamps only if the SYN did", cfg };
+      test.execute( Tick { 5 } );
+      test.execute( Receive { TCPReceiverMessage { .window_size = 1000 } }.without_push() );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( nullopt ).with_seqno( isn ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "A SYN-ACK answers a timestamp with its own", cfg };
+      test.execute( Tick { 5 } );
+      test.execute( Receive { TCPReceiverMessage { .window_size = 1000 } }.with_timestamp_echo( 0 ).without_push() );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 5 ).with_seqno( isn ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "Every segment is stamped once both ends use timestamps", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 7 } );
+      test.execute( Receive { { isn + 1, 1000 } }.with_timestamp_echo( 0 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( 7 ) );
+      test.execute( Tick { 3 } );
+      test.execute( Push { "def" } );
+      test.execute( ExpectMessage {}.with_data( "def" ).with_timestamp( 10 ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.timestamps = true;
+      cfg.adaptive_rto = true;
+
+      TCPSenderTestHarness test { "Retransmissions are restamped, and timed from the echo", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( Receive { { isn + 1, 1000 } }.with_timestamp_echo( 0 ) );
+      test.execute( ExpectSRTT { 100 } );
+      test.execute( ExpectRTO { 300 } );
+
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( 100 ) );
+      test.execute( Tick { 300 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( 400 ) );
+      test.execute( Tick { 50 } );
+      test.execute( Receive { { isn + 4, 1000 } }.with_timestamp_echo( 400 ) );
+      test.execute( ExpectSRTT { 93.75 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.timestamps = true;
+      cfg.adaptive_rto = true;
+
+      TCPSenderTestHarness test { "RTTs below a millisecond are timed from the send time, not the echo", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 0 ).with_seqno( isn ) );
+      test.execute( TickUs { 300 } );
+      test.execute( Receive { { isn + 1, 1000 } }.with_timestamp_echo( 0 ) );
+      test.execute( ExpectSRTT { 0.3 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( 0 ) );
+      test.execute( TickUs { 300 } );
+      test.execute( Receive { { isn + 4, 1000 } }.with_timestamp_echo( 0 ) );
+      test.execute( ExpectSRTT { 0.3 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.recv_capacity = 1'000'000;
+
+      TCPSenderTestHarness test { "No window scale offered by default", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_window_scale( nullopt ).with_seqno( isn ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.recv_capacity = 1'000'000;
+      cfg.window_scaling = true;
+
+      TCPSenderTestHarness test { "SYN offers the scale of the receive capacity", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_window_scale( 4 ).with_seqno( isn ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.send_capacity = 200'000;
+      cfg.window_scaling = true;
+
+      TCPSenderTestHarness test { "Scaled window keeps more than 64 KB in flight", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+
+      // the SYN's own window isn't scaled
+      test.execute( Receive { { isn + 1, 1000 } }.with_window_scale( 2 ) );
+      test.execute( Push { string( 2000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // ... but the windows after it are
+      test.execute( Receive { { isn + 1001, 25000 } } );
+      test.execute( Push { string( 118000, 'x' ) } );
+      for ( unsigned i = 0; i < 100; i++ ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1001 + 1000 * i ).with_payload_size( 1000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 100'000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.send_capacity = 200'000;
+
+      TCPSenderTestHarness test { "Peer's window scale is ignored unless we offered one", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 1000 } }.with_window_scale( 2 ) );
+      test.execute( Receive { { isn + 1, 3000 } } );
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( unsigned i = 0; i < 3; i++ ) {
+        test.execute( ExpectMessage {}.with_seqno( isn + 1 + 1000 * i ).with_payload_size( 1000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.send_capacity = 200'000;
+      cfg.recv_capacity = 1'000'000;
+      cfg.window_scaling = true;
+
+      TCPSenderTestHarness test { "A SYN-ACK offers a window scale only if the SYN did", cfg };
+      test.execute( Receive { TCPReceiverMessage { .window_size = 1000 } }.without_push() );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_window_scale( nullopt ).with_seqno( isn ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.send_capacity = 200'000;
+      cfg.recv_capacity = 1'000'000;
+      cfg.window_scaling = true;
+
+      TCPSenderTestHarness test { "A SYN-ACK answers a window scale with its own", cfg };
+      test.execute( Receive { TCPReceiverMessage { .window_size = 1000 } }.with_window_scale( 2 ).without_push() );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_window_scale( 4 ).with_seqno( isn ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.send_capacity = 200'000;
+      cfg.window_scaling = true;
+
+      TCPSenderTestHarness test { "Window scale is capped at 14", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Receive { { isn + 1, 0 } }.with_window_scale( 20 ).without_push() );
+      test.execute( Receive { { isn + 1, 4 } }.without_push() );
+      test.execute( Push { string( 70000, 'x' ) } );
+      test.execute( ExpectSeqnosInFlight { 65536 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
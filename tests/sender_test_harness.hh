@@ -14,6 +14,19 @@
 
 const unsigned int DEFAULT_TEST_WINDOW = 137;
 
+inline std::string congestion_control_name( CongestionControl::Algorithm algorithm )
+{
+  switch ( algorithm ) {
+    case CongestionControl::Algorithm::NewReno:
+      return ", NewReno";
+    case CongestionControl::Algorithm::Cubic:
+      return ", CUBIC";
+    case CongestionControl::Algorithm::None:
+      break;
+  }
+  return "";
+}
+
 struct SenderAndOutput
 {
   TCPSender sender;
@@ -54,8 +67,16 @@ class TCPSenderTestHarness : public TestHarness<SenderAndOutput>
 public:
   TCPSenderTestHarness( std::string name, TCPConfig config )
     : TestHarness( move( name ),
-                   "initial_RTO_ms=" + to_string( config.rt_timeout ) + " and ISN=" + to_string( config.isn ),
-                   { TCPSender { ByteStream { config.send_capacity }, config.isn, config.rt_timeout } } )
+                   "initial_RTO_ms=" + to_string( config.rt_timeout ) + " and ISN=" + to_string( config.isn )
+                     + ( config.sack ? ", SACK" : "" ) + congestion_control_name( config.congestion_control )
+                     + ( config.adaptive_rto ? ", adaptive RTO" : "" )
+                     + ( config.fast_retransmit ? ", fast retransmit" : "" )
+                     + ( config.window_scaling ? ", window scaling" : "" )
+                     + ( config.timestamps ? ", timestamps" : "" )
+                     + ( config.nagle ? ", Nagle" : "" ) + ( config.cork ? ", corked" : "" )
+                     + ( config.sws_avoidance ? ", SWS avoidance" : "" )
+                     + ( config.mss != TCPConfig::MAX_PAYLOAD_SIZE ? ", MSS=" + to_string( config.mss ) : "" ),
+                   { TCPSender { ByteStream { config.send_capacity }, config.isn, config.rt_timeout, config } } )
   {}
 
   template<std::derived_from<TestStep<TCPSender>> T>
@@ -97,6 +118,34 @@ struct ExpectSeqnosInFlight : public ExpectNumber<TCPSender, uint64_t>
   uint64_t value( const TCPSender& sender ) const override { return sender.sequence_numbers_in_flight(); }
 };
 
+struct ExpectCongestionWindow : public ExpectNumber<TCPSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "congestion_window"; }
+  uint64_t value( const TCPSender& sender ) const override { return sender.congestion_window(); }
+};
+
+struct ExpectMaxPayloadSize : public ExpectNumber<TCPSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "max_payload_size"; }
+  uint64_t value( const TCPSender& sender ) const override { return sender.max_payload_size(); }
+};
+
+struct ExpectRTO : public ExpectNumber<TCPSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "rtt_estimator().rto_ms()"; }
+  uint64_t value( const TCPSender& sender ) const override { return sender.rtt_estimator().rto_ms(); }
+};
+
+struct ExpectSRTT : public ExpectNumber<TCPSender, double>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "rtt_estimator().srtt_ms()"; }
+  double value( const TCPSender& sender ) const override { return sender.rtt_estimator().srtt_ms(); }
+};
+
 struct ExpectConsecutiveRetransmissions : public ExpectNumber<TCPSender, uint64_t>
 {
   using ExpectNumber::ExpectNumber;
@@ -133,6 +182,7 @@ struct Push : public Action<SenderAndOutput>
 {
   std::string data_;
   bool close_ {};
+  bool flush_ {};
 
   explicit Push( std::string data = "" ) : data_( move( data ) ) {}
   std::string description() const override
@@ -146,7 +196,7 @@ struct Push : public Action<SenderAndOutput>
     }
 
     return "push \"" + pretty_print( data_ ) + "\" to stream" + ( close_ ? ", close it" : "" )
-           + ", then push to TCPSender";
+           + ( flush_ ? ", flush" : "" ) + ", then push to TCPSender";
   }
   void execute( SenderAndOutput& ss ) const override
   {
@@ -156,6 +206,9 @@ struct Push : public Action<SenderAndOutput>
     if ( close_ ) {
       ss.sender.writer().close();
     }
+    if ( flush_ ) {
+      ss.sender.flush();
+    }
     ss.sender.push( ss.make_transmit() );
   }
 
@@ -165,6 +218,27 @@ struct Push : public Action<SenderAndOutput>
     return *this;
   }
 
+  Push& with_flush()
+  {
+    flush_ = true;
+    return *this;
+  }
+
+  constexpr std::string obj() const override { return "TCPSender"; }
+};
+
+struct SetCork : public Action<SenderAndOutput>
+{
+  bool cork_;
+
+  explicit SetCork( bool cork ) : cork_( cork ) {}
+  std::string description() const override { return cork_ ? "cork, then push" : "uncork, then push"; }
+  void execute( SenderAndOutput& ss ) const override
+  {
+    ss.sender.set_cork( cork_ );
+    ss.sender.push( ss.make_transmit() );
+  }
+
   constexpr std::string obj() const override { return "TCPSender"; }
 };
 
@@ -213,16 +287,42 @@ struct Tick : public Action<SenderAndOutput>
   constexpr std::string obj() const override { return "TCPSender"; }
 };
 
+struct TickUs : public Action<SenderAndOutput>
+{
+  uint64_t us_;
+
+  explicit TickUs( uint64_t us ) : us_( us ) {}
+  std::string description() const override { return std::to_string( us_ ) + " us pass"; }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.tick_us( us_, ss.make_transmit() ); }
+  constexpr std::string obj() const override { return "TCPSender"; }
+};
+
 struct Receive : public Action<SenderAndOutput>
 {
   TCPReceiverMessage msg_;
   bool push_ = true;
+  bool no_mss_ = false;
 
   explicit Receive( TCPReceiverMessage msg ) : msg_( msg ) {}
   std::string description() const override
   {
     std::ostringstream desc;
-    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size << ")";
+    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size;
+    if ( not msg_.sack.empty() ) {
+      desc << ", sack=" << to_string( msg_.sack );
+    }
+    if ( msg_.window_scale.has_value() ) {
+      desc << ", wscale=" << +*msg_.window_scale;
+    }
+    if ( msg_.timestamp_echo.has_value() ) {
+      desc << ", TSecr=" << *msg_.timestamp_echo;
+    }
+    if ( msg_.mss.has_value() ) {
+      desc << ", MSS=" << *msg_.mss;
+    } else if ( no_mss_ ) {
+      desc << ", no MSS";
+    }
+    desc << ")";
     if ( push_ ) {
       desc << ", then push";
     }
@@ -235,9 +335,44 @@ struct Receive : public Action<SenderAndOutput>
     return *this;
   }
 
+  Receive& with_window_scale( uint8_t scale )
+  {
+    msg_.window_scale = scale;
+    return *this;
+  }
+
+  Receive& with_timestamp_echo( uint32_t echo )
+  {
+    msg_.timestamp_echo = echo;
+    return *this;
+  }
+
+  Receive& with_mss( uint16_t mss )
+  {
+    msg_.mss = mss;
+    return *this;
+  }
+
+  Receive& with_sack( Wrap32 left, Wrap32 right )
+  {
+    msg_.sack.emplace_back( left, right );
+    return *this;
+  }
+
+  Receive& without_mss()
+  {
+    no_mss_ = true;
+    return *this;
+  }
+
   void execute( SenderAndOutput& ss ) const override
   {
-    ss.sender.receive( msg_ );
+    // Until the SYN is acked, the peer offers the default MSS unless the test says otherwise
+    TCPReceiverMessage msg = msg_;
+    if ( not ss.sender.syn_acked() and not msg.mss.has_value() and not no_mss_ ) {
+      msg.mss = TCPConfig::MAX_PAYLOAD_SIZE;
+    }
+    ss.sender.receive( msg );
     if ( push_ ) {
       ss.sender.push( ss.make_transmit() );
     }
@@ -283,8 +418,16 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
   std::optional<Wrap32> seqno {};
   std::optional<std::string> data {};
   std::optional<size_t> payload_size {};
+  std::optional<bool> sack_permitted {};
+  std::optional<std::optional<uint8_t>> window_scale {};
+  std::optional<std::optional<uint32_t>> timestamp {};
+  std::optional<std::optional<uint16_t>> mss {};
 
-  bool empty() const { return not( syn or fin or rst or seqno or data or payload_size ); }
+  bool empty() const
+  {
+    return not( syn or fin or rst or seqno or data or payload_size or sack_permitted or window_scale or timestamp
+                or mss );
+  }
 
   ExpectMessage& with_syn( bool syn_ )
   {
@@ -310,6 +453,30 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     return *this;
   }
 
+  ExpectMessage& with_sack_permitted( bool sack_permitted_ )
+  {
+    sack_permitted = sack_permitted_;
+    return *this;
+  }
+
+  ExpectMessage& with_window_scale( std::optional<uint8_t> window_scale_ )
+  {
+    window_scale = window_scale_;
+    return *this;
+  }
+
+  ExpectMessage& with_timestamp( std::optional<uint32_t> timestamp_ )
+  {
+    timestamp = timestamp_;
+    return *this;
+  }
+
+  ExpectMessage& with_mss( std::optional<uint16_t> mss_ )
+  {
+    mss = mss_;
+    return *this;
+  }
+
   ExpectMessage& with_seqno( Wrap32 seqno_ )
   {
     seqno = seqno_;
@@ -339,6 +506,18 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     if ( syn.has_value() ) {
       o << ( syn.value() ? " +SYN" : " -SYN" );
     }
+    if ( sack_permitted.has_value() ) {
+      o << ( sack_permitted.value() ? " +SACK_PERM" : " -SACK_PERM" );
+    }
+    if ( window_scale.has_value() ) {
+      o << ( window_scale->has_value() ? " +WSCALE=" + std::to_string( **window_scale ) : " -WSCALE" );
+    }
+    if ( timestamp.has_value() ) {
+      o << ( timestamp->has_value() ? " TSval=" + std::to_string( **timestamp ) : " (no TSval)" );
+    }
+    if ( mss.has_value() ) {
+      o << ( mss->has_value() ? " MSS=" + std::to_string( **mss ) : " (no MSS)" );
+    }
 
     if ( data.has_value() and data.value().size() <= 32 ) {
       o << " payload=\"" << pretty_print( data.value(), 32 ) << "\"";
@@ -377,10 +556,10 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
 
     const TCPSenderMessage seg = ss.expect_message();
 
-    if ( seg.payload.size() > TCPConfig::MAX_PAYLOAD_SIZE ) {
+    if ( seg.payload.size() > ss.sender.max_payload_size() ) {
       throw ExpectationViolation( "sent a message with a " + std::to_string( seg.payload.size() )
                                   + "-byte payload, which is longer than the maximum ("
-                                  + std::to_string( TCPConfig::MAX_PAYLOAD_SIZE ) + ")" );
+                                  + std::to_string( ss.sender.max_payload_size() ) + ")" );
     }
     if ( syn.has_value() and seg.SYN != syn.value() ) {
       throw MessageExpectationViolation( seg, "SYN flag", syn.value(), seg.SYN );
@@ -391,6 +570,18 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     if ( rst.has_value() and seg.RST != rst.value() ) {
       throw MessageExpectationViolation( seg, "RST flag", rst.value(), seg.RST );
     }
+    if ( sack_permitted.has_value() and seg.SACK_permitted != sack_permitted.value() ) {
+      throw MessageExpectationViolation( seg, "SACK-permitted option", sack_permitted.value(), seg.SACK_permitted );
+    }
+    if ( window_scale.has_value() and seg.window_scale != window_scale.value() ) {
+      throw MessageExpectationViolation( seg, "window scale option", window_scale.value(), seg.window_scale );
+    }
+    if ( timestamp.has_value() and seg.timestamp != timestamp.value() ) {
+      throw MessageExpectationViolation( seg, "timestamp", timestamp.value(), seg.timestamp );
+    }
+    if ( mss.has_value() and seg.mss != mss.value() ) {
+      throw MessageExpectationViolation( seg, "MSS option", mss.value(), seg.mss );
+    }
     if ( seqno.has_value() and seg.seqno != seqno.value() ) {
       throw MessageExpectationViolation( seg, "sequence number", seqno.value(), seg.seqno );
     }
@@ -0,0 +1,163 @@
+#include "spsc_byte_stream.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <poll.h>
+#include <random>
+#include <thread>
+
+using namespace std;
+using namespace std::chrono;
+
+// Sleep until `fd` becomes readable
+void wait_for( const FileDescriptor& fd )
+{
+  pollfd pfd { fd.fd_num(), POLLIN, 0 };
+  if ( ::poll( &pfd, 1, -1 ) < 0 ) {
+    throw runtime_error( "poll" );
+  }
+}
+
+void writer_thread( SPSCByteStream::Writer& writer,
+                    const string& data,
+                    const size_t write_size, // NOLINT(bugprone-easily-swappable-parameters)
+                    const bool sleep )
+{
+  size_t offset = 0;
+  while ( offset < data.size() ) {
+    if ( writer.available_capacity() == 0 ) {
+      if ( sleep ) {
+        writer.clear_wakeup();
+        if ( writer.available_capacity() == 0 ) {
+          wait_for( writer.wakeup_fd() );
+        }
+      } else {
+        this_thread::yield();
+      }
+      continue;
+    }
+
+    const auto before = writer.bytes_pushed();
+    writer.push( string_view( data ).substr( offset, write_size ) );
+    offset += writer.bytes_pushed() - before;
+  }
+  writer.close();
+}
+
+double speed_test( fstream& debug_output,
+                   const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
+                   const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                   const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                   const size_t write_size,  // NOLINT(bugprone-easily-swappable-parameters)
+                   const size_t read_size,   // NOLINT(bugprone-easily-swappable-parameters)
+                   const bool sleep )
+{
+  // Generate the data to be written
+  const string data = [&random_seed, &input_len] {
+    default_random_engine rd { random_seed };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < input_len; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  SPSCByteStream bs { capacity };
+  if ( sleep ) {
+    bs.enable_wakeups();
+  }
+  string output_data;
+  output_data.reserve( data.size() );
+
+  const auto start_time = steady_clock::now();
+
+  // The writer side runs on its own thread; this thread owns the reader side.
+  thread writer { writer_thread, ref( bs.writer() ), cref( data ), write_size, sleep };
+
+  auto& reader = bs.reader();
+  while ( not reader.is_finished() ) {
+    if ( reader.bytes_buffered() == 0 ) {
+      if ( sleep ) {
+        reader.clear_wakeup();
+        if ( reader.bytes_buffered() == 0 and not reader.is_finished() ) {
+          wait_for( reader.wakeup_fd() );
+        }
+      } else {
+        this_thread::yield();
+      }
+      continue;
+    }
+
+    auto peeked = reader.peek().substr( 0, read_size );
+    if ( peeked.empty() ) {
+      throw runtime_error( "SPSCByteStream::reader().peek() returned empty view" );
+    }
+    output_data += peeked;
+    reader.pop( peeked.size() );
+  }
+
+  writer.join();
+  const auto stop_time = steady_clock::now();
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and read" );
+  }
+
+  auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  auto bytes_per_second = static_cast<double>( input_len ) / test_duration.count();
+  auto bits_per_second = 8 * bytes_per_second;
+  auto gigabits_per_second = bits_per_second / 1e9;
+
+  const string mode = sleep ? "eventfd wakeups" : "spinning";
+  cout << "SPSCByteStream (" << mode << ") with capacity=" << capacity << ", write_size=" << write_size
+       << ", read_size=" << read_size << " reached " << fixed << setprecision( 2 ) << gigabits_per_second
+       << " Gbit/s.\n";
+
+  auto read_s = to_string( read_size );
+  const string fill( 5 - read_s.size(), ' ' );
+  debug_output << "        SPSCByteStream throughput (" << mode << ", pop length " << read_s << "):" << fill
+               << fixed << setprecision( 2 ) << setw( 5 ) << gigabits_per_second << " Gbit/s\n";
+
+  if ( sleep and gigabits_per_second < 0.1 ) {
+    throw runtime_error( "SPSCByteStream did not meet minimum speed of 0.1 Gbit/s" );
+  }
+  // (A spinning reader and writer compete for the cores with whatever else runs, so they only have to show that
+  // they didn't stall)
+  if ( not sleep and gigabits_per_second < 0.01 ) {
+    throw runtime_error( "SPSCByteStream (spinning) did not meet minimum speed of 0.01 Gbit/s" );
+  }
+
+  return gigabits_per_second;
+}
+
+void program_body()
+{
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  // Two threads that spin on one core only make progress when the scheduler swaps them
+  if ( thread::hardware_concurrency() >= 2 ) {
+    speed_test( debug_output, 1e7, 32768, 789, 1500, 4096, false );
+    speed_test( debug_output, 1e7, 32768, 789, 1500, 128, false );
+  } else {
+    cout << "SPSCByteStream (spinning) skipped on a single core.\n";
+  }
+  speed_test( debug_output, 1e7, 32768, 789, 1500, 4096, true );
+  speed_test( debug_output, 1e7, 32768, 789, 1500, 128, true );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,207 @@
+#include "tcp_engine.hh"
+
+#include "tcp_over_ip.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Deliver every datagram one engine has sent to the other
+void exchange( TCPEngine& from, TCPEngine& to )
+{
+  auto& datagrams = from.datagrams_out();
+  while ( not datagrams.empty() ) {
+    to.receive( move( datagrams.front() ) );
+    datagrams.pop();
+  }
+}
+
+string read_all( Reader& reader )
+{
+  string data;
+  while ( reader.bytes_buffered() ) {
+    data += reader.peek();
+    reader.pop( reader.peek().size() );
+  }
+  return data;
+}
+
+void many_connections()
+{
+  constexpr size_t count = 200;
+  constexpr uint16_t server_port = 80;
+  const Address server_address { "10.144.0.1", server_port };
+
+  TCPEngine client { TCPConfig {} };
+  TCPEngine server { TCPConfig {} };
+  server.listen( server_port );
+
+  // Every client connection says something of its own, and expects to hear it back
+  unordered_map<uint16_t, FourTuple> client_connections;
+  unordered_map<uint16_t, string> received;
+  for ( uint16_t port = 10000; port < 10000 + count; port++ ) {
+    client_connections.emplace( port, client.connect( Address { "10.144.0.2", port }, server_address ) );
+  }
+  if ( client.connections() != count ) {
+    throw runtime_error( "client has " + to_string( client.connections() ) + " connections, not "
+                         + to_string( count ) );
+  }
+
+  unordered_map<uint16_t, FourTuple> accepted;
+  for ( unsigned round = 0; round < 2000 and ( client.connections() or server.connections() ); round++ ) {
+    exchange( client, server );
+    exchange( server, client );
+
+    while ( const auto tuple = server.accept( server_port ) ) {
+      if ( tuple->local_port != server_port or not accepted.emplace( tuple->remote_port, *tuple ).second ) {
+        throw runtime_error( "server accepted an unexpected connection: " + tuple->to_string() );
+      }
+    }
+
+    // Once connected, each client writes its message and closes
+    for ( const auto& [port, tuple] : client_connections ) {
+      TCPPeer* peer = client.find( tuple );
+      if ( peer and peer->sender().sequence_numbers_in_flight() == 0 and not peer->outbound_writer().is_closed() ) {
+        peer->outbound_writer().push( "hello from port " + to_string( port ) );
+        peer->outbound_writer().close();
+        client.push( tuple );
+      }
+      if ( peer ) {
+        received[port] += read_all( peer->inbound_reader() );
+      }
+    }
+
+    // The server echoes what it hears, and closes when the client has
+    for ( const auto& [port, tuple] : accepted ) {
+      TCPPeer* peer = server.find( tuple );
+      if ( peer and not peer->outbound_writer().is_closed() ) {
+        peer->outbound_writer().push( read_all( peer->inbound_reader() ) );
+        if ( peer->inbound_reader().is_finished() ) {
+          peer->outbound_writer().close();
+        }
+        server.push( tuple );
+      }
+    }
+
+    client.tick( 10 );
+    server.tick( 10 );
+  }
+
+  if ( accepted.size() != count ) {
+    throw runtime_error( "server accepted " + to_string( accepted.size() ) + " connections, not "
+                         + to_string( count ) );
+  }
+  for ( const auto& [port, tuple] : client_connections ) {
+    if ( received[port] != "hello from port " + to_string( port ) ) {
+      throw runtime_error( "connection from port " + to_string( port ) + " got back \"" + received[port] + "\"" );
+    }
+  }
+  if ( client.connections() or server.connections() ) {
+    throw runtime_error( "connections were not forgotten after they finished" );
+  }
+}
+
+// Connections with nothing to do have no timers set, so letting time pass doesn't touch them
+void idle_connections_have_no_timers()
+{
+  constexpr size_t count = 100;
+  const Address server_address { "10.144.0.1", 80 };
+
+  TCPEngine client { TCPConfig {} };
+  TCPEngine server { TCPConfig {} };
+  server.listen( 80 );
+
+  vector<FourTuple> connections;
+  for ( uint16_t port = 10000; port < 10000 + count; port++ ) {
+    connections.push_back( client.connect( Address { "10.144.0.2", port }, server_address ) );
+  }
+  if ( client.timers() != count ) {
+    throw runtime_error( "a SYN in flight has no retransmission timer" );
+  }
+
+  for ( unsigned round = 0; round < 10; round++ ) {
+    exchange( client, server );
+    exchange( server, client );
+    client.tick( 10 );
+    server.tick( 10 );
+  }
+  if ( client.connections() != count or server.connections() != count ) {
+    throw runtime_error( "connections were not established" );
+  }
+  if ( client.timers() or server.timers() ) {
+    throw runtime_error( "idle connections have timers set" );
+  }
+
+  // Sending sets the retransmission timer of just the one connection that sent
+  client.find( connections.front() )->outbound_writer().push( "hello" );
+  client.push( connections.front() );
+  if ( client.timers() != 1 ) {
+    throw runtime_error( "client has " + to_string( client.timers() ) + " timers set, not 1" );
+  }
+  for ( unsigned round = 0; round < 10; round++ ) {
+    exchange( client, server );
+    exchange( server, client );
+    client.tick( 10 );
+    server.tick( 10 );
+  }
+  if ( client.timers() or server.timers() ) {
+    throw runtime_error( "a timer is still set after the data was delivered and acknowledged" );
+  }
+}
+
+void strays_are_ignored()
+{
+  const Address server_address { "10.144.0.1", 80 };
+  const Address client_address { "10.144.0.2", 10000 };
+
+  TCPEngine server { TCPConfig {} };
+  server.listen( 80 );
+
+  const auto datagram = [&]( uint16_t dst_port, bool SYN, bool ack ) {
+    TCPSenderMessage sender { .seqno = Wrap32 { 0 }, .SYN = SYN };
+    TCPReceiverMessage receiver { .ackno = ack ? optional { Wrap32 { 1 } } : nullopt };
+    return TCPOverIPv4Adapter::wrap_tcp_in_ip( { move( sender ), move( receiver ) },
+                                               client_address.ipv4_numeric(),
+                                               client_address.port(),
+                                               server_address.ipv4_numeric(),
+                                               dst_port );
+  };
+
+  // Segments for no connection, a SYN to a port nobody is listening on, and a SYN-ACK go unanswered
+  server.receive( datagram( 80, false, true ) );
+  server.receive( datagram( 81, true, false ) );
+  server.receive( datagram( 80, true, true ) );
+  if ( server.connections() or server.listener( 80 )->syn_queue_size() or not server.datagrams_out().empty() ) {
+    throw runtime_error( "server reacted to a segment that wasn't for it" );
+  }
+
+  // ... but a SYN to a listening port is answered
+  server.receive( datagram( 80, true, false ) );
+  if ( server.listener( 80 )->syn_queue_size() != 1 or server.datagrams_out().size() != 1 ) {
+    throw runtime_error( "server did not answer a SYN" );
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    strays_are_ignored();
+    idle_connections_have_no_timers();
+    many_connections();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,236 @@
+#include "tcp_engine.hh"
+
+#include "helpers.hh"
+#include "tcp_over_ip.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+constexpr uint16_t server_port = 80;
+const Address server_address { "10.144.0.1", server_port };
+
+void exchange( TCPEngine& from, TCPEngine& to )
+{
+  auto& datagrams = from.datagrams_out();
+  while ( not datagrams.empty() ) {
+    to.receive( move( datagrams.front() ) );
+    datagrams.pop();
+  }
+}
+
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( what );
+  }
+}
+
+vector<FourTuple> connect_many( TCPEngine& client, size_t count )
+{
+  vector<FourTuple> tuples;
+  for ( uint16_t port = 10000; port < 10000 + count; port++ ) {
+    tuples.push_back( client.connect( Address { "10.144.0.2", port }, server_address ) );
+  }
+  return tuples;
+}
+
+size_t accept_all( TCPEngine& server )
+{
+  size_t accepted = 0;
+  while ( server.accept( server_port ) ) {
+    accepted++;
+  }
+  return accepted;
+}
+
+// Completed connections wait in the backlog; handshakes that find it full complete once it has room
+void backlog()
+{
+  TCPEngine client { TCPConfig {} };
+  TCPEngine server { TCPConfig {} };
+  server.listen( server_port, 4 );
+  connect_many( client, 10 );
+
+  exchange( client, server ); // SYNs
+  exchange( server, client ); // SYN-ACKs
+  exchange( client, server ); // ACKs
+  expect( server.connections() == 4, "backlog of 4 let " + to_string( server.connections() ) + " connections in" );
+  expect( server.listener( server_port )->syn_queue_size() == 6, "handshakes beyond the backlog were lost" );
+
+  size_t accepted = accept_all( server );
+  for ( unsigned round = 0; round < 1000 and accepted < 10; round++ ) {
+    client.tick( 10 );
+    server.tick( 10 );
+    exchange( client, server );
+    exchange( server, client );
+    accepted += accept_all( server );
+  }
+  expect( accepted == 10, "only " + to_string( accepted ) + " connections were accepted" );
+}
+
+// Once the SYN queue is full, SYN cookies complete the handshake, and the connections they make work (without
+// the options a cookie can't remember)
+void cookies()
+{
+  TCPConfig config;
+  config.window_scaling = config.sack = config.timestamps = true;
+  config.send_capacity = config.recv_capacity = 1 << 20;
+  config.mss = TCPConfig::mss_for_mtu( 1500 );
+
+  TCPEngine client { config };
+  TCPEngine server { config };
+  server.listen( server_port, TCPListener::DEFAULT_BACKLOG, 2 );
+  const vector<FourTuple> tuples = connect_many( client, 20 );
+
+  exchange( client, server );
+
+  // Only the SYN-ACKs from the SYN queue offer options
+  size_t with_options = 0;
+  auto syn_acks = server.datagrams_out();
+  for ( ; not syn_acks.empty(); syn_acks.pop() ) {
+    InternetDatagram& dgram = syn_acks.front();
+    TCPSegment seg;
+    expect( parse( seg, move( dgram.payload ), dgram.header.pseudo_checksum() ), "unparseable SYN-ACK" );
+    const TCPSenderMessage& msg = seg.message.sender;
+    with_options += msg.window_scale.has_value() and msg.SACK_permitted and msg.timestamp.has_value();
+    expect( msg.mss == config.mss, "a SYN-ACK didn't offer the MSS" );
+  }
+  expect( with_options == 2, to_string( with_options ) + " SYN-ACKs offered options, not 2" );
+
+  exchange( server, client );
+  exchange( client, server );
+  const TCPListener& listener = *server.listener( server_port );
+  expect( listener.cookies_sent() == 18, "sent " + to_string( listener.cookies_sent() ) + " cookies, not 18" );
+  expect( accept_all( server ) == 20, "not every handshake completed" );
+
+  // A megabyte over the last connection, which has no window scaling: its windows must agree on that
+  const string data( 1 << 20, 'x' );
+  Writer& writer = client.find( tuples.back() )->outbound_writer();
+  size_t received = 0;
+  const FourTuple server_side { tuples.back().remote_address,
+                                tuples.back().remote_port,
+                                tuples.back().local_address,
+                                tuples.back().local_port };
+  for ( unsigned round = 0; round < 10000 and received < data.size(); round++ ) {
+    writer.push( data.substr( writer.bytes_pushed(), writer.available_capacity() ) );
+    client.push( tuples.back() );
+    exchange( client, server );
+    Reader& reader = server.find( server_side )->inbound_reader();
+    received += reader.bytes_buffered();
+    reader.pop( reader.bytes_buffered() );
+    server.push( server_side );
+    exchange( server, client );
+    client.tick( 1 );
+    server.tick( 1 );
+  }
+  expect( received == data.size(), "only " + to_string( received ) + " bytes crossed a cookie connection" );
+
+  // An ACK that doesn't carry a valid cookie opens nothing
+  TCPSenderMessage forged_sender { .seqno = Wrap32 { 1000 } };
+  TCPReceiverMessage forged_receiver { .ackno = Wrap32 { 12345 } };
+  const size_t before = server.connections();
+  server.receive( TCPOverIPv4Adapter::wrap_tcp_in_ip( { move( forged_sender ), move( forged_receiver ) },
+                                                      Address { "10.144.0.3" }.ipv4_numeric(),
+                                                      20000,
+                                                      server_address.ipv4_numeric(),
+                                                      server_port ) );
+  expect( server.connections() == before and not server.accept( server_port ), "a forged ACK opened a connection" );
+}
+
+// A flood of SYNs that are never completed takes no more than the SYN queue, which empties after the SYN-ACKs
+// have been retransmitted
+void syn_flood()
+{
+  TCPConfig config;
+  config.syn_cookies = false;
+  TCPEngine server { config };
+  server.listen( server_port, TCPListener::DEFAULT_BACKLOG, 64 );
+
+  for ( uint32_t i = 0; i < 10000; i++ ) {
+    TCPSenderMessage syn { .seqno = Wrap32 { i }, .SYN = true };
+    server.receive( TCPOverIPv4Adapter::wrap_tcp_in_ip( { move( syn ), TCPReceiverMessage {} },
+                                                        Address { "10.144.1.1" }.ipv4_numeric() + i / 1000,
+                                                        static_cast<uint16_t>( 1024 + i ),
+                                                        server_address.ipv4_numeric(),
+                                                        server_port ) );
+  }
+  const TCPListener& listener = *server.listener( server_port );
+  expect( listener.syn_queue_size() == 64, "SYN queue grew to " + to_string( listener.syn_queue_size() ) );
+  expect( server.datagrams_out().size() == 64 and listener.cookies_sent() == 0, "answered SYNs it couldn't keep" );
+  expect( server.connections() == 0, "a SYN alone opened a connection" );
+
+  // The SYN-ACKs are resent after 1, 2, 4, 8 and 16 seconds, and the last one is given 32 more
+  for ( unsigned round = 0; round < 6299; round++ ) {
+    server.tick( 10 );
+  }
+  expect( listener.syn_queue_size() == 64, "half-open connections expired too early" );
+  server.tick( 10 );
+  expect( listener.syn_queue_size() == 0, "half-open connections were never forgotten" );
+  expect( server.datagrams_out().size() == 64 * ( 1 + TCPListener::MAX_SYN_ACK_RETX ), "wrong SYN-ACK count" );
+}
+
+// A SYN that offers no options is answered by a SYN-ACK that offers none either (RFC 7323), and the connection it
+// opens doesn't scale its windows or stamp its segments
+void syn_without_options()
+{
+  TCPConfig config;
+  config.window_scaling = config.timestamps = true;
+  config.recv_capacity = 1 << 20;
+  TCPEngine server { config };
+  server.listen( server_port );
+
+  const auto send = [&]( TCPSenderMessage sender, TCPReceiverMessage receiver ) {
+    server.receive( TCPOverIPv4Adapter::wrap_tcp_in_ip( { move( sender ), move( receiver ) },
+                                                        Address { "10.144.0.3" }.ipv4_numeric(),
+                                                        20000,
+                                                        server_address.ipv4_numeric(),
+                                                        server_port ) );
+  };
+  const auto reply = [&] {
+    auto& datagrams = server.datagrams_out();
+    expect( datagrams.size() == 1, "sent " + to_string( datagrams.size() ) + " segments, not one" );
+    TCPSegment seg;
+    expect( parse( seg, move( datagrams.front().payload ), datagrams.front().header.pseudo_checksum() ),
+            "unparseable reply" );
+    datagrams.pop();
+    return seg;
+  };
+
+  send( { .seqno = Wrap32 { 1000 }, .SYN = true }, {} );
+  const TCPSegment syn_ack = reply();
+  expect( not syn_ack.message.sender->window_scale.has_value(), "the SYN-ACK offered a window scale" );
+  expect( not syn_ack.message.sender->timestamp.has_value(), "the SYN-ACK offered timestamps" );
+
+  const Wrap32 ackno = syn_ack.message.sender->seqno + 1;
+  send( { .seqno = Wrap32 { 1001 } }, { .ackno = ackno, .window_size = UINT16_MAX } );
+  expect( accept_all( server ) == 1, "the handshake didn't complete" );
+  send( { .seqno = Wrap32 { 1001 }, .payload = "hello" }, { .ackno = ackno, .window_size = UINT16_MAX } );
+  const TCPSegment ack = reply();
+  expect( ack.message.receiver->window_size == UINT16_MAX, "the connection scaled its window" );
+  expect( not ack.message.sender->timestamp.has_value(), "the connection stamped its ACK" );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    backlog();
+    cookies();
+    syn_flood();
+    syn_without_options();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
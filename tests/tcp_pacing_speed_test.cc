@@ -0,0 +1,206 @@
+#include "helpers.hh"
+#include "ipv4_header.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// A simulated path, one millisecond at a time: a bottleneck that forwards `rate` bytes per millisecond from a
+// drop-tail queue of `queue_limit` packets, followed by `delay_ms` of propagation delay. Segments cross it
+// serialized, as they would in IP datagrams.
+class Link
+{
+public:
+  Link( uint64_t rate, size_t queue_limit, uint64_t delay_ms )
+    : rate_( rate ), queue_limit_( queue_limit ), delay_ms_( delay_ms )
+  {}
+
+  void send( TCPMessage msg )
+  {
+    if ( queue_.size() >= queue_limit_ ) {
+      drops_++;
+      return;
+    }
+    TCPSegment seg { .message = move( msg ) };
+    seg.compute_checksum( 0 );
+    queue_.push_back( serialize( seg ) );
+    max_queue_ = max( max_queue_, queue_.size() );
+  }
+
+  // Let one millisecond pass, then deliver every packet that has reached the far end
+  void advance( uint64_t now_ms, TCPPeer& receiver, const TCPPeer::TransmitFunction& transmit )
+  {
+    credit_ = queue_.empty() ? rate_ : credit_ + rate_;
+    while ( not queue_.empty() and size( queue_.front() ) <= credit_ ) {
+      credit_ -= size( queue_.front() );
+      in_flight_.emplace_back( now_ms + delay_ms_, move( queue_.front() ) );
+      queue_.pop_front();
+    }
+
+    while ( not in_flight_.empty() and in_flight_.front().first <= now_ms ) {
+      TCPSegment seg;
+      if ( not parse( seg, move( in_flight_.front().second ), 0 ) ) {
+        throw runtime_error( "could not parse a segment" );
+      }
+      in_flight_.pop_front();
+      receiver.receive( move( seg.message ), transmit );
+    }
+  }
+
+  uint64_t drops() const { return drops_; }
+  size_t max_queue() const { return max_queue_; }
+
+private:
+  using Packet = vector<Ref<string>>;
+
+  static uint64_t size( const Packet& packet )
+  {
+    uint64_t bytes = IPv4Header::LENGTH;
+    for ( const auto& buffer : packet ) {
+      bytes += buffer->size();
+    }
+    return bytes;
+  }
+
+  uint64_t rate_;
+  size_t queue_limit_;
+  uint64_t delay_ms_;
+  uint64_t credit_ {};
+  deque<Packet> queue_ {};
+  deque<pair<uint64_t, Packet>> in_flight_ {};
+  uint64_t drops_ {};
+  size_t max_queue_ {};
+};
+
+TCPPeer::TransmitFunction onto( Link& link, uint64_t& segments )
+{
+  return [&link, &segments]( TCPMessage msg ) {
+    segments++;
+    link.send( move( msg ) );
+  };
+}
+
+void pacing_test( bool pacing, string_view scenario )
+{
+  // 20 Mbit/s, 20 ms round trip: a bandwidth-delay product of 50 kB, and a queue of only ten packets
+  constexpr uint64_t rate = 2500;
+  constexpr size_t queue_limit = 10;
+  constexpr uint64_t one_way_delay_ms = 10;
+
+  // The application sends bursts of data with pauses in between (like a video stream's chunks)
+  constexpr size_t chunk_size = 256 << 10;
+  constexpr unsigned chunks = 16;
+  constexpr uint64_t pause_ms = 200;
+  constexpr uint64_t time_limit_ms = 120'000;
+
+  TCPConfig cfg;
+  cfg.mss = TCPConfig::mss_for_mtu( 1500 );
+  cfg.send_capacity = cfg.recv_capacity = 1 << 20;
+  cfg.window_scaling = true;
+  cfg.sack = true;
+  cfg.fast_retransmit = true;
+  cfg.adaptive_rto = true;
+  cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+  cfg.pacing = pacing;
+
+  TCPPeer client { cfg };
+  TCPPeer server { cfg };
+  Link uplink { rate, queue_limit, one_way_delay_ms };
+  Link downlink { UINT64_MAX / 2, SIZE_MAX, one_way_delay_ms };
+  uint64_t segments = 0;
+  uint64_t acks = 0;
+  const auto client_transmit = onto( uplink, segments );
+  const auto server_transmit = onto( downlink, acks );
+
+  default_random_engine rd { 144 };
+  uniform_int_distribution<char> ud;
+  string chunk( chunk_size, 0 );
+  for ( auto& ch : chunk ) {
+    ch = ud( rd );
+  }
+
+  uint64_t received = 0;
+  uint64_t now_ms = 0;
+  uint64_t next_chunk_ms = 0;
+  unsigned chunks_written = 0;
+  uint64_t chunk_written = 0;
+  client.push( client_transmit );
+
+  while ( received < chunks * chunk_size ) {
+    if ( ++now_ms > time_limit_ms ) {
+      throw runtime_error( "transfer over the simulated link did not finish" );
+    }
+    client.tick( 1, client_transmit );
+    server.tick( 1, server_transmit );
+
+    // Write the next chunk once the previous one has been delivered and the pause is over
+    if ( chunks_written < chunks and now_ms >= next_chunk_ms and received >= chunks_written * chunk_size ) {
+      Writer& writer = client.outbound_writer();
+      const uint64_t len = min( writer.available_capacity(), chunk_size - chunk_written );
+      writer.push( chunk.substr( chunk_written, len ) );
+      chunk_written += len;
+      if ( chunk_written == chunk_size ) {
+        chunk_written = 0;
+        chunks_written++;
+      }
+      client.push( client_transmit );
+    }
+
+    uplink.advance( now_ms, server, server_transmit );
+    downlink.advance( now_ms, client, client_transmit );
+
+    Reader& reader = server.inbound_reader();
+    const uint64_t before = received;
+    received += reader.bytes_buffered();
+    reader.pop( reader.bytes_buffered() );
+    if ( before < chunks_written * chunk_size and received >= chunks_written * chunk_size ) {
+      next_chunk_ms = now_ms + pause_ms;
+    }
+  }
+
+  const uint64_t busy_ms = now_ms - ( chunks - 1 ) * pause_ms;
+  const double goodput = 8.0 * static_cast<double>( received ) / static_cast<double>( busy_ms ) / 1000;
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "TCP " << ( pacing ? "with" : "without" ) << " pacing sent " << segments << " segments over a "
+       << queue_limit << "-packet queue: " << uplink.drops() << " dropped, at most " << uplink.max_queue()
+       << " queued, " << fixed << setprecision( 2 ) << goodput << " Mbit/s while busy.\n";
+
+  debug_output << "        TCP " << scenario << setw( 6 ) << segments << " segments, " << setw( 5 )
+               << uplink.drops() << " dropped, " << fixed << setprecision( 2 ) << setw( 5 ) << goodput
+               << " Mbit/s\n";
+}
+
+void program_body()
+{
+  pacing_test( false, "(bursts, no pacing):  " );
+  pacing_test( true, "(bursts, paced):      " );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
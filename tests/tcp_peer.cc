@@ -0,0 +1,268 @@
+#include "tcp_peer.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const Wrap32 client_isn { 5000 }; // (the client is played by the test, one segment at a time)
+
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( what );
+  }
+}
+
+// A TCPPeer acting as the server, and the segments it has sent (copied, since it reuses them)
+class Server
+{
+public:
+  explicit Server( const TCPConfig& config ) : isn_( config.isn ), capacity_( config.recv_capacity ), peer_( config )
+  {}
+
+  // (every segment after the SYN acknowledges our SYN-ACK, and the SYN's options go on both halves, as they do
+  // when a segment is parsed from the wire)
+  void receive( TCPSenderMessage sender_message )
+  {
+    TCPReceiverMessage receiver_message { .window_size = UINT16_MAX };
+    if ( sender_message.SYN ) {
+      receiver_message.window_scale = sender_message.window_scale;
+      receiver_message.mss = sender_message.mss;
+    } else {
+      receiver_message.ackno = isn_ + 1;
+    }
+    peer_.receive( { move( sender_message ), move( receiver_message ) }, record() );
+  }
+
+  void data( uint64_t index, const string& payload, bool FIN = false )
+  {
+    receive( { .seqno = client_isn + 1 + index, .payload = payload, .FIN = FIN } );
+  }
+
+  void tick( uint64_t ms ) { peer_.tick( ms, record() ); }
+  void push() { peer_.push( record() ); }
+  Reader& reader() { return peer_.inbound_reader(); }
+  Writer& writer() { return peer_.outbound_writer(); }
+  const TCPSender& sender() const { return peer_.sender(); }
+
+  // The segments sent since the last call
+  vector<TCPMessage> take_sent() { return exchange( sent_, {} ); }
+
+  // Check that exactly one pure ACK went out since the last call, acknowledging `index` bytes of the stream
+  // (and the FIN, if given)
+  void expect_ack( uint64_t index, const string& what, bool FIN = false, optional<uint16_t> window = {} )
+  {
+    expect( sent_.size() == 1, what + ": sent " + to_string( sent_.size() ) + " segments, not one ACK" );
+    const TCPMessage& msg = sent_.front();
+    expect( msg.sender->sequence_length() == 0, what + ": the ACK took up a sequence number" );
+    expect( msg.receiver->ackno == client_isn + 1 + index + FIN,
+            what + ": wrong ackno " + to_string( msg.receiver->ackno->unwrap( client_isn, 0 ) ) );
+    expect( not window.has_value() or msg.receiver->window_size == *window,
+            what + ": window " + to_string( msg.receiver->window_size ) );
+    sent_.clear();
+  }
+
+  void expect_nothing( const string& what )
+  {
+    expect( sent_.empty(), what + ": sent " + to_string( sent_.size() ) + " segments, expected none" );
+  }
+
+  // Open the connection: the SYN is answered right away (with an unscaled window, whatever the SYN offers), and
+  // the ACK of our SYN-ACK needs no reply
+  void handshake( optional<uint8_t> window_scale = {} )
+  {
+    receive( { .seqno = client_isn, .SYN = true, .window_scale = window_scale, .mss = TCPConfig::MAX_PAYLOAD_SIZE } );
+    expect( sent_.size() == 1 and sent_.front().sender->SYN, "the SYN wasn't answered with a SYN-ACK" );
+    expect( sent_.front().receiver->window_size == min<uint64_t>( capacity_, UINT16_MAX ),
+            "the SYN-ACK's window was " + to_string( sent_.front().receiver->window_size ) );
+    sent_.clear();
+    receive( { .seqno = client_isn + 1 } );
+    expect_nothing( "ACK of the SYN-ACK" );
+  }
+
+private:
+  Wrap32 isn_;
+  uint64_t capacity_;
+  TCPPeer peer_;
+  vector<TCPMessage> sent_ {};
+
+  TCPPeer::TransmitFunction record()
+  {
+    return [&]( const TCPMessage& msg ) {
+      sent_.push_back( { TCPSenderMessage { msg.sender.get() }, TCPReceiverMessage { msg.receiver.get() } } );
+    };
+  }
+};
+
+TCPConfig delayed_ack_config()
+{
+  TCPConfig config;
+  config.delayed_ack = true;
+  return config;
+}
+
+// A lone in-order segment is acked once ACK_DELAY_MS has passed
+void ack_delay()
+{
+  Server server { delayed_ack_config() };
+  server.handshake();
+
+  server.data( 0, string( 100, 'a' ) );
+  server.expect_nothing( "first in-order segment" );
+  server.tick( TCPConfig::ACK_DELAY_MS - 1 );
+  server.expect_nothing( "before the ACK delay" );
+  server.tick( 1 );
+  server.expect_ack( 100, "after the ACK delay" );
+  server.tick( TCPConfig::ACK_DELAY_MS );
+  server.expect_nothing( "after the delayed ACK" );
+}
+
+// Every second in-order segment is acked right away, covering both
+void ack_every()
+{
+  Server server { delayed_ack_config() };
+  server.handshake();
+
+  server.data( 0, string( 100, 'a' ) );
+  server.tick( 10 );
+  server.data( 100, string( 100, 'b' ) );
+  server.expect_ack( 200, "second in-order segment" );
+  server.tick( TCPConfig::ACK_DELAY_MS );
+  server.expect_nothing( "after both segments were acked" );
+
+  server.data( 200, string( 100, 'c' ) );
+  server.expect_nothing( "third in-order segment" );
+  server.data( 300, string( 100, 'd' ) );
+  server.expect_ack( 400, "fourth in-order segment" );
+}
+
+// Out-of-order data, the segment that fills the hole, and a FIN are all acked right away
+void immediate_acks()
+{
+  Server server { delayed_ack_config() };
+  server.handshake();
+
+  server.data( 0, string( 100, 'a' ) );
+  server.expect_nothing( "in-order segment" );
+  server.data( 200, string( 100, 'c' ) );
+  server.expect_ack( 100, "out-of-order segment" );
+  server.data( 100, string( 100, 'b' ) );
+  server.expect_ack( 300, "segment that fills the hole" );
+  server.data( 300, string( 100, 'd' ), true );
+  server.expect_ack( 400, "FIN", true );
+}
+
+// Once the application reads from a window that had closed, the new window is advertised right away (but once
+// the window is back to half the buffer, the sender isn't waiting for more)
+void window_update()
+{
+  TCPConfig config = delayed_ack_config();
+  config.recv_capacity = 2000;
+  Server server { config };
+  server.handshake();
+
+  server.data( 0, string( 1000, 'a' ) );
+  server.data( 1000, string( 1000, 'b' ) );
+  server.expect_ack( 2000, "segment that fills the window", false, 0 );
+
+  server.reader().pop( 500 );
+  server.push();
+  server.expect_nothing( "less than a segment freed" );
+  server.reader().pop( 500 );
+  server.tick( 1 );
+  server.expect_ack( 2000, "a segment freed", false, 1000 );
+  server.reader().pop( 1000 );
+  server.push();
+  server.expect_nothing( "the rest freed" );
+}
+
+// Our windows are scaled once the peer has acknowledged the SYN-ACK that offered it
+void window_scaling()
+{
+  TCPConfig config;
+  config.window_scaling = true;
+  config.recv_capacity = 1'000'000;
+  Server server { config };
+  server.handshake( 7 );
+
+  server.data( 0, string( 100, 'a' ) );
+  server.expect_ack( 100, "first segment", false, ( config.recv_capacity - 100 ) >> config.recv_window_scale() );
+}
+
+// Segments that carry the peer's data don't count as duplicate acks, even though they don't advance the ackno
+void two_way_data()
+{
+  TCPConfig config;
+  config.fast_retransmit = true;
+  config.congestion_control = CongestionControl::Algorithm::NewReno;
+  Server server { config };
+  server.handshake();
+
+  server.writer().push( string( 3000, 's' ) );
+  server.push();
+  expect( server.take_sent().size() == 3, "the server didn't send 3 segments" );
+  const uint64_t cwnd = server.sender().congestion_window();
+
+  for ( uint64_t i = 0; i < 2 * TCPConfig::DUP_THRESH; i++ ) {
+    server.data( 100 * i, string( 100, 'c' ) );
+    for ( const TCPMessage& msg : server.take_sent() ) {
+      expect( msg.sender->sequence_length() == 0, "the server resent a segment after the client's data" );
+    }
+  }
+  expect( server.sender().congestion_window() == cwnd, "the client's data shrank the congestion window" );
+  expect( server.sender().sequence_numbers_in_flight() == 3000, "the server's segments were taken as lost" );
+}
+
+// A delayed ACK echoes the timestamp of the first segment it covers, so that the sender's RTT includes the delay
+void delayed_ack_timestamps()
+{
+  TCPConfig config = delayed_ack_config();
+  config.timestamps = true;
+  Server server { config };
+  server.receive( { .seqno = client_isn, .SYN = true, .timestamp = 10 } );
+  server.take_sent();
+  server.receive( { .seqno = client_isn + 1, .timestamp = 11 } );
+
+  server.receive( { .seqno = client_isn + 1, .payload = string( 100, 'a' ), .timestamp = 20 } );
+  server.expect_nothing( "first in-order segment" );
+  server.receive( { .seqno = client_isn + 101, .payload = string( 100, 'b' ), .timestamp = 30 } );
+  const vector<TCPMessage> sent = server.take_sent();
+  expect( sent.size() == 1 and sent.front().receiver->timestamp_echo == 20,
+          "the delayed ACK didn't echo the first segment's timestamp" );
+
+  server.receive( { .seqno = client_isn + 201, .payload = string( 100, 'c' ), .timestamp = 40 } );
+  server.tick( TCPConfig::ACK_DELAY_MS );
+  const vector<TCPMessage> later = server.take_sent();
+  expect( later.size() == 1 and later.front().receiver->timestamp_echo == 40,
+          "the next ACK didn't echo the segment after the last one acked" );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    ack_delay();
+    ack_every();
+    immediate_acks();
+    window_update();
+    window_scaling();
+    two_way_data();
+    delayed_ack_timestamps();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
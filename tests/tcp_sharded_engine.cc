@@ -0,0 +1,173 @@
+#include "sharded_tcp_engine.hh"
+
+#include "ipv4_header.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( what );
+  }
+}
+
+// The verification examples from Microsoft's RSS specification (IPv4 with TCP ports)
+void rss_hash()
+{
+  const FourTuple first {
+    Address { "161.142.100.80" }.ipv4_numeric(), 1766, Address { "66.9.149.187" }.ipv4_numeric(), 2794 };
+  const FourTuple second {
+    Address { "65.69.140.83" }.ipv4_numeric(), 4739, Address { "199.92.111.2" }.ipv4_numeric(), 14230 };
+  expect( first.rss_hash() == 0x51ccc178, "wrong RSS hash for the first example" );
+  expect( second.rss_hash() == 0xc626b0ea, "wrong RSS hash for the second example" );
+}
+
+// Every connection lives on the shard its hash picks, on both sides, and carries its data
+void sharded_echo()
+{
+  constexpr size_t shards = 3;
+  constexpr size_t flows = 30;
+  constexpr uint16_t server_port = 80;
+  const Address server_address { "10.144.0.1", server_port };
+  const string message = "hello, shard";
+
+  struct alignas( 64 ) State
+  {
+    vector<FourTuple> connections {};
+    vector<bool> echoed {};
+    atomic<size_t> done {};
+  };
+  vector<State> client_state( shards );
+  vector<State> server_state( shards );
+  atomic<bool> misplaced {};
+
+  ShardedTCPEngine client { TCPConfig {}, shards, [&]( ShardedTCPEngine::Shard& shard ) {
+                             State& state = client_state[shard.index()];
+                             if ( state.connections.empty() ) {
+                               for ( size_t i = shard.index(); i < flows; i += shards ) {
+                                 const FourTuple tuple = shard.connect( Address { "10.144.0.2" }, server_address );
+                                 if ( ShardedTCPEngine::shard_of( tuple, shards ) != shard.index() ) {
+                                   misplaced = true;
+                                 }
+                                 state.connections.push_back( tuple );
+                                 state.echoed.push_back( false );
+                               }
+                             }
+                             for ( size_t i = 0; i < state.connections.size(); i++ ) {
+                               TCPPeer* peer = shard.engine().find( state.connections[i] );
+                               if ( not peer ) {
+                                 continue;
+                               }
+                               if ( peer->sender().sequence_numbers_in_flight() == 0
+                                    and not peer->outbound_writer().is_closed() ) {
+                                 peer->outbound_writer().push( message );
+                                 peer->outbound_writer().close();
+                                 shard.engine().push( state.connections[i] );
+                               }
+                               Reader& reader = peer->inbound_reader();
+                               if ( not state.echoed[i] and reader.peek() == message ) {
+                                 reader.pop( message.size() );
+                                 state.echoed[i] = true;
+                                 state.done++;
+                               }
+                             }
+                           } };
+
+  ShardedTCPEngine server { TCPConfig {}, shards, [&]( ShardedTCPEngine::Shard& shard ) {
+                             State& state = server_state[shard.index()];
+                             while ( const auto tuple = shard.engine().accept( server_port ) ) {
+                               if ( ShardedTCPEngine::shard_of( *tuple, shards ) != shard.index() ) {
+                                 misplaced = true;
+                               }
+                               state.connections.push_back( *tuple );
+                             }
+                             for ( const auto& tuple : state.connections ) {
+                               TCPPeer* peer = shard.engine().find( tuple );
+                               if ( peer and peer->inbound_reader().bytes_buffered() == message.size() ) {
+                                 peer->outbound_writer().push( string { peer->inbound_reader().peek() } );
+                                 peer->inbound_reader().pop( message.size() );
+                                 peer->outbound_writer().close();
+                                 shard.engine().push( tuple );
+                               }
+                             }
+                           } };
+  server.listen( server_port );
+
+  const auto finished = [&] {
+    size_t total = 0;
+    for ( const auto& state : client_state ) {
+      total += state.done;
+    }
+    return total == flows;
+  };
+
+  client.start();
+  server.start();
+  const auto start_time = steady_clock::now();
+  while ( not finished() and steady_clock::now() - start_time < seconds { 10 } ) {
+    client.collect( [&]( InternetDatagram& dgram ) { server.receive( move( dgram ) ); } );
+    server.collect( [&]( InternetDatagram& dgram ) { client.receive( move( dgram ) ); } );
+    this_thread::yield();
+  }
+  client.stop();
+  server.stop();
+
+  expect( finished(), "not every flow was echoed" );
+  expect( not misplaced, "a connection lived on a shard its hash didn't pick" );
+  size_t accepted = 0;
+  for ( const auto& state : server_state ) {
+    expect( not state.connections.empty(), "a server shard got no connections" );
+    accepted += state.connections.size();
+  }
+  expect( accepted == flows, "server accepted " + to_string( accepted ) + " connections" );
+}
+
+// A worker with nothing to do sleeps, and wakes when a datagram is handed to its shard
+void idle_worker_sleeps()
+{
+  atomic<uint64_t> rounds {};
+  ShardedTCPEngine engine { TCPConfig {}, 1, [&]( ShardedTCPEngine::Shard& ) { rounds++; } };
+  engine.start();
+  this_thread::sleep_for( milliseconds { 200 } );
+  const uint64_t idle_rounds = rounds;
+  expect( idle_rounds < 10, "an idle worker ran " + to_string( idle_rounds ) + " rounds in 200 ms" );
+
+  InternetDatagram dgram;
+  dgram.header.proto = IPv4Header::PROTO_TCP;
+  dgram.payload.emplace_back( string( 4, '\0' ) );
+  expect( engine.receive( move( dgram ) ), "the datagram wasn't queued" );
+  const auto start_time = steady_clock::now();
+  while ( rounds == idle_rounds and steady_clock::now() - start_time < seconds { 1 } ) {
+    this_thread::yield();
+  }
+  engine.stop();
+  expect( rounds > idle_rounds, "the worker didn't wake for a datagram" );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    rss_hash();
+    sharded_echo();
+    idle_worker_sleeps();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
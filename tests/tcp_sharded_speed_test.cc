@@ -0,0 +1,165 @@
+#include "sharded_tcp_engine.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <pthread.h>
+#include <sched.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+constexpr uint16_t server_port = 80;
+const Address server_address { "10.144.0.1", server_port };
+const Address client_address { "10.144.0.2" };
+
+// What one shard's part of the application keeps (each is only touched by its own worker thread)
+struct alignas( 64 ) ShardState
+{
+  vector<FourTuple> connections {};
+  vector<size_t> written {};
+  atomic<uint64_t> received {};
+};
+
+void sharded_test( size_t shards, size_t flows, size_t bytes_per_flow )
+{
+  TCPConfig cfg;
+  cfg.mss = TCPConfig::mss_for_mtu( 1500 );
+
+  const string data( bytes_per_flow, 'x' );
+
+  // Each client shard opens its share of the flows and sends on all of them
+  vector<ShardState> client_state( shards );
+  ShardedTCPEngine client { cfg, shards, [&]( ShardedTCPEngine::Shard& shard ) {
+                             ShardState& state = client_state[shard.index()];
+                             if ( state.connections.empty() ) {
+                               for ( size_t i = shard.index(); i < flows; i += shards ) {
+                                 state.connections.push_back( shard.connect( client_address, server_address ) );
+                                 state.written.push_back( 0 );
+                               }
+                             }
+                             for ( size_t i = 0; i < state.connections.size(); i++ ) {
+                               TCPPeer* peer = shard.engine().find( state.connections[i] );
+                               if ( not peer or peer->outbound_writer().is_closed() ) {
+                                 continue;
+                               }
+                               Writer& writer = peer->outbound_writer();
+                               writer.push( data.substr( state.written[i], writer.available_capacity() ) );
+                               state.written[i] = writer.bytes_pushed();
+                               if ( state.written[i] == data.size() ) {
+                                 writer.close();
+                               }
+                               shard.engine().push( state.connections[i] );
+                             }
+                           } };
+
+  // Each server shard accepts what is steered to it, and reads everything
+  vector<ShardState> server_state( shards );
+  ShardedTCPEngine server { cfg, shards, [&]( ShardedTCPEngine::Shard& shard ) {
+                             ShardState& state = server_state[shard.index()];
+                             while ( const auto tuple = shard.engine().accept( server_port ) ) {
+                               state.connections.push_back( *tuple );
+                             }
+                             for ( const auto& tuple : state.connections ) {
+                               if ( TCPPeer* peer = shard.engine().find( tuple ) ) {
+                                 Reader& reader = peer->inbound_reader();
+                                 state.received += reader.bytes_buffered();
+                                 reader.pop( reader.bytes_buffered() );
+                               }
+                             }
+                           } };
+  server.listen( server_port );
+
+  // Each worker gets a core of its own after the I/O thread's, as long as there are enough to go around
+  client.pin_to_cores( 1 );
+  server.pin_to_cores( 1 + shards );
+
+  const auto total_received = [&] {
+    uint64_t total = 0;
+    for ( const auto& state : server_state ) {
+      total += state.received.load();
+    }
+    return total;
+  };
+
+  const auto start_time = steady_clock::now();
+  client.start();
+  server.start();
+
+  // This thread is the "network" between the two
+  while ( total_received() < flows * bytes_per_flow ) {
+    const size_t moved = client.collect( [&]( InternetDatagram& dgram ) { server.receive( move( dgram ) ); } )
+                         + server.collect( [&]( InternetDatagram& dgram ) { client.receive( move( dgram ) ); } );
+    if ( moved == 0 ) {
+      this_thread::yield();
+    }
+    if ( steady_clock::now() - start_time > seconds { 60 } ) {
+      throw runtime_error( "sharded transfer did not finish" );
+    }
+  }
+
+  const auto duration = duration_cast<microseconds>( steady_clock::now() - start_time ).count();
+  client.stop();
+  server.stop();
+
+  const auto gigabits_per_second
+    = [&]( uint64_t bytes ) { return 8.0 * static_cast<double>( bytes ) / static_cast<double>( duration ) / 1000; };
+  const double total_rate = gigabits_per_second( flows * bytes_per_flow );
+  ostringstream per_shard;
+  per_shard << fixed << setprecision( 2 );
+  for ( const auto& state : server_state ) {
+    per_shard << ( &state == &server_state.front() ? "" : ", " ) << gigabits_per_second( state.received );
+  }
+  const unsigned cores = thread::hardware_concurrency();
+  const char* sharing = cores < 2 * shards + 1 ? ", sharing cores" : "";
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "Sharded TCP engine with " << shards << " shard" << ( shards == 1 ? "" : "s" ) << " moved " << flows
+       << " flows at " << fixed << setprecision( 2 ) << total_rate << " Gbit/s (per shard: " << per_shard.str()
+       << ").\n";
+
+  debug_output << "        Sharded TCP engine (" << shards << " shard" << ( shards == 1 ? "):  " : "s): " )
+               << fixed << setprecision( 2 ) << setw( 5 ) << total_rate << " Gbit/s with " << flows
+               << " flows, per shard " << per_shard.str() << " (" << cores << " cores" << sharing << ")\n";
+}
+
+void program_body()
+{
+  // (This thread is the I/O thread: keep it on core 0, out of the workers' way)
+  cpu_set_t cpus;
+  CPU_ZERO( &cpus );
+  CPU_SET( 0, &cpus );
+  if ( pthread_setaffinity_np( pthread_self(), sizeof( cpus ), &cpus ) != 0 ) {
+    throw runtime_error( "couldn't pin the I/O thread to core 0" );
+  }
+
+  for ( const size_t shards : { 1, 2, 4 } ) {
+    sharded_test( shards, 16, 4 << 20 );
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+#include "helpers.hh"
+#include "ipv4_header.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <random>
+
+using namespace std;
+using namespace std::chrono;
+
+void speed_test( const TCPConfig& config, string_view scenario )
+{
+  constexpr size_t data_size = 16 << 20;
+
+  // Generate the data to be sent
+  const string data = [&] {
+    default_random_engine rd { config.mss };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < data_size; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  TCPConfig cfg = config;
+  cfg.window_scaling = true;
+  cfg.send_capacity = cfg.recv_capacity = 1 << 20;
+
+  TCPPeer client { cfg };
+  TCPPeer server { cfg };
+
+  // Segments cross the "wire" serialized, as they would in IP datagrams
+  queue<vector<Ref<string>>> to_server;
+  queue<vector<Ref<string>>> to_client;
+  uint64_t segments = 0;
+  uint64_t acks = 0;
+  uint64_t wire_bytes = 0;
+
+  const auto wire = [&]( queue<vector<Ref<string>>>& link, bool count ) {
+    return [&link, &segments, &acks, &wire_bytes, count]( TCPMessage msg ) {
+      TCPSegment seg { .message = move( msg ) };
+      seg.compute_checksum( 0 );
+      auto buffers = serialize( seg );
+      if ( not count ) {
+        acks++;
+      } else {
+        segments++;
+        wire_bytes += IPv4Header::LENGTH;
+        for ( const auto& buffer : buffers ) {
+          wire_bytes += buffer->size();
+        }
+      }
+      link.push( move( buffers ) );
+    };
+  };
+  const TCPPeer::TransmitFunction client_transmit = wire( to_server, true );
+  const TCPPeer::TransmitFunction server_transmit = wire( to_client, false );
+
+  const auto deliver = []( queue<vector<Ref<string>>>& link, TCPPeer& peer, const auto& transmit ) {
+    TCPSegment seg;
+    if ( not parse( seg, move( link.front() ), 0 ) ) {
+      throw runtime_error( "could not parse a segment" );
+    }
+    link.pop();
+    peer.receive( move( seg.message ), transmit );
+  };
+
+  string output_data;
+  output_data.reserve( data.size() );
+  size_t written = 0;
+
+  const auto start_time = steady_clock::now();
+  while ( output_data.size() < data.size() ) {
+    Writer& writer = client.outbound_writer();
+    const size_t len = min( writer.available_capacity(), data.size() - written );
+    writer.push( data.substr( written, len ) );
+    written += len;
+    client.push( client_transmit );
+
+    while ( not to_server.empty() ) {
+      deliver( to_server, server, server_transmit );
+      Reader& reader = server.inbound_reader();
+      while ( reader.bytes_buffered() ) {
+        output_data += reader.peek();
+        reader.pop( output_data.size() - reader.bytes_popped() );
+      }
+    }
+    while ( not to_client.empty() ) {
+      deliver( to_client, client, client_transmit );
+    }
+
+    // Each round trip takes a millisecond (which lets a delayed ACK come due)
+    server.tick( 1, server_transmit );
+    client.tick( 1, client_transmit );
+  }
+  const auto stop_time = steady_clock::now();
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data sent and received" );
+  }
+
+  auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  auto bytes_per_second = static_cast<double>( data.size() ) / test_duration.count();
+  auto gigabits_per_second = 8 * bytes_per_second / 1e9;
+  auto overhead = 100.0 * static_cast<double>( wire_bytes - data.size() ) / static_cast<double>( wire_bytes );
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "TCP with MSS=" << cfg.mss << ( cfg.timestamps ? " and timestamps" : "" )
+       << ( cfg.delayed_ack ? " and delayed ACKs" : "" ) << " sent " << segments << " segments (and got " << acks
+       << " ACKs) with " << fixed << setprecision( 2 ) << overhead << "% header overhead, at "
+       << gigabits_per_second << " Gbit/s.\n";
+
+  debug_output << "        TCP " << scenario << setw( 8 ) << segments << " segments, " << setw( 6 ) << acks
+               << " ACKs, " << fixed << setprecision( 2 ) << setw( 5 ) << overhead << "% headers, " << setw( 5 )
+               << gigabits_per_second << " Gbit/s\n";
+
+  if ( gigabits_per_second < 0.1 ) {
+    throw runtime_error( "TCP did not meet minimum speed of 0.1 Gbit/s." );
+  }
+}
+
+TCPConfig with_mss( uint16_t mss )
+{
+  TCPConfig cfg;
+  cfg.mss = mss;
+  return cfg;
+}
+
+void program_body()
+{
+  const TCPConfig ethernet = with_mss( TCPConfig::mss_for_mtu( 1500 ) );
+  TCPConfig timestamps = ethernet;
+  timestamps.timestamps = true;
+  TCPConfig delayed_ack = ethernet;
+  delayed_ack.delayed_ack = true;
+
+  speed_test( with_mss( 536 ), "(MSS 536, RFC 9293 default): " );
+  speed_test( with_mss( TCPConfig::MAX_PAYLOAD_SIZE ), "(MSS 1000, minnow default):  " );
+  speed_test( ethernet, "(MSS 1460, 1500-byte MTU):   " );
+  speed_test( timestamps, "(same, with timestamps):     " );
+  speed_test( delayed_ack, "(same, with delayed ACKs):   " );
+  speed_test( with_mss( TCPConfig::mss_for_mtu( 9000 ) ), "(MSS 8960, jumbo frames):    " );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
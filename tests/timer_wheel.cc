@@ -0,0 +1,148 @@
+#include "timer_wheel.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( what );
+  }
+}
+
+// Timers go off in the millisecond they are due, on every level, and can be reset and cancelled
+void basics()
+{
+  TimerWheel<int> wheel;
+  vector<pair<int, uint64_t>> fired;
+  const auto record = [&]( int key ) { fired.emplace_back( key, wheel.now() ); };
+
+  wheel.schedule( 1, 5 );
+  wheel.schedule( 2, 64 );
+  wheel.schedule( 3, 4097 );
+  wheel.schedule( 4, 300'000 );
+  wheel.schedule( 5, 10 );
+  wheel.schedule( 5, 20 ); // reset
+  wheel.schedule( 6, 30 );
+  wheel.cancel( 6 );
+  expect( wheel.size() == 5, "wrong number of timers set" );
+  expect( wheel.deadline( 5 ) == 20 and not wheel.deadline( 6 ).has_value(), "wrong deadlines" );
+
+  wheel.advance( 4, record );
+  expect( fired.empty(), "a timer went off early" );
+  wheel.advance( 1'000'000, record );
+  const vector<pair<int, uint64_t>> expected { { 1, 5 }, { 5, 20 }, { 2, 64 }, { 3, 4097 }, { 4, 300'000 } };
+  expect( fired == expected, "timers went off at the wrong times" );
+  expect( wheel.empty(), "timers left over" );
+
+  // A deadline that has already passed goes off at the next advance, even without time passing
+  fired.clear();
+  wheel.schedule( 7, 10 );
+  wheel.advance( wheel.now(), record );
+  expect( fired == vector<pair<int, uint64_t>> { { 7, 1'000'000 } }, "an overdue timer didn't go off" );
+
+  // next_event() is when the next timer goes off on level 0, or a coarser slot is reached, whichever is sooner
+  expect( not wheel.next_event().has_value(), "next_event() with no timers set" );
+  wheel.schedule( 8, 1'000'030 );
+  wheel.schedule( 9, 1'000'500 );
+  expect( wheel.next_event() == 1'000'030, "wrong next_event() on level 0" );
+  wheel.cancel( 8 );
+  expect( wheel.next_event() == 1'000'448, "wrong next_event() on level 1" );
+  wheel.schedule( 10, 5 );
+  expect( wheel.next_event() == 1'000'000, "wrong next_event() for an overdue timer" );
+}
+
+// A deadline beyond the coarsest level's reach waits, and goes off on time
+void far_deadline()
+{
+  TimerWheel<int> wheel { 12345 };
+  const uint64_t deadline = wheel.now() + TimerWheel<int>::SPAN + 1000;
+  wheel.schedule( 1, deadline );
+  uint64_t fired_at = 0;
+  wheel.advance( deadline + 10, [&]( int ) { fired_at = wheel.now(); } );
+  expect( fired_at == deadline, "far timer went off at " + to_string( fired_at ) );
+}
+
+// Random schedules, resets and cancels (some made from inside expire()), against a map of deadlines
+void randomized()
+{
+  default_random_engine rng { 0 };
+  TimerWheel<unsigned> wheel;
+  map<unsigned, uint64_t> due; // key -> the time it should go off
+
+  const auto set = [&]( unsigned key, uint64_t deadline ) {
+    wheel.schedule( key, deadline );
+    due[key] = max( deadline, wheel.now() ); // (an overdue timer goes off at the next advance)
+  };
+  const auto by_time = []( const auto& a, const auto& b ) { return a.second < b.second; };
+
+  for ( unsigned round = 0; round < 20000; round++ ) {
+    const unsigned key = uniform_int_distribution<unsigned> { 0, 999 }( rng );
+    switch ( uniform_int_distribution<unsigned> { 0, 3 }( rng ) ) {
+      case 0:
+        wheel.cancel( key );
+        due.erase( key );
+        break;
+      case 1: {
+        const uint64_t range = uint64_t { 1 } << uniform_int_distribution<unsigned> { 0, 20 }( rng );
+        const uint64_t earliest = wheel.now() - min( wheel.now(), uint64_t { 2 } );
+        set( key, earliest + uniform_int_distribution<uint64_t> {}( rng ) % range );
+        break;
+      }
+      default: {
+        const uint64_t target = wheel.now() + uniform_int_distribution<uint64_t> { 0, 3000 }( rng );
+        const auto next_event = wheel.next_event();
+        expect( next_event.has_value() == not due.empty(), "next_event() disagrees on whether a timer is set" );
+        if ( next_event.has_value() and *next_event > min_element( due.begin(), due.end(), by_time )->second ) {
+          throw runtime_error( "next_event() is after a timer's deadline" );
+        }
+        wheel.advance( target, [&]( unsigned fired ) {
+          const auto it = due.find( fired );
+          expect( it != due.end(), "a cancelled timer went off" );
+          if ( it->second != wheel.now() ) {
+            throw runtime_error( "timer due at " + to_string( it->second ) + " went off at "
+                                 + to_string( wheel.now() ) );
+          }
+          if ( wheel.now() < next_event.value_or( 0 ) ) {
+            throw runtime_error( "a timer went off before next_event()" );
+          }
+          due.erase( it );
+          if ( uniform_int_distribution<unsigned> { 0, 3 }( rng ) == 0 ) {
+            set( fired, wheel.now() + 1 + fired % 500 );
+          }
+        } );
+        expect( wheel.now() == target, "clock didn't reach the target" );
+        if ( not due.empty() and min_element( due.begin(), due.end(), by_time )->second <= target ) {
+          throw runtime_error( "a timer didn't go off by " + to_string( target ) );
+        }
+      }
+    }
+    expect( wheel.size() == due.size(), "wrong number of timers set" );
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    basics();
+    far_deadline();
+    randomized();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
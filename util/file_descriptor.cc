@@ -88,18 +88,23 @@ void FileDescriptor::read( string& buffer )
     buffer.resize( kReadBufferSize );
   }
 
+  buffer.resize( read( span { buffer.data(), buffer.size() } ) );
+}
+
+// buffer is the memory to be read into (e.g. space reserved inside a ByteStream)
+size_t FileDescriptor::read( span<char> buffer )
+{
   const ssize_t bytes_read = ::read( fd_num(), buffer.data(), buffer.size() );
   if ( bytes_read < 0 ) {
     if ( internal_fd_->non_blocking_ and ( errno == EAGAIN or errno == EINPROGRESS ) ) {
-      buffer.clear();
-      return;
+      return 0;
     }
     throw unix_error { "read" };
   }
 
   register_read();
 
-  if ( bytes_read == 0 ) {
+  if ( bytes_read == 0 and not buffer.empty() ) {
     internal_fd_->eof_ = true;
   }
 
@@ -107,7 +112,7 @@ void FileDescriptor::read( string& buffer )
     throw runtime_error( "read() read more than requested" );
   }
 
-  buffer.resize( bytes_read );
+  return bytes_read;
 }
 
 void FileDescriptor::read( vector<string>& buffers )
@@ -0,0 +1,87 @@
+#include "mirrored_buffer.hh"
+
+#include "exception.hh"
+#include "file_descriptor.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+
+using namespace std;
+
+namespace {
+void* check_mmap( const string_view s_attempt, void* const address )
+{
+  if ( address == MAP_FAILED ) { // NOLINT(*-cstyle-cast, performance-no-int-to-ptr)
+    throw unix_error { s_attempt };
+  }
+  return address;
+}
+} // namespace
+
+MirroredBuffer::MirroredBuffer( size_t min_size )
+{
+  const size_t page_size = ::CheckSystemCall( "sysconf", static_cast<int>( sysconf( _SC_PAGESIZE ) ) );
+  size_ = max( page_size, ( min_size + page_size - 1 ) / page_size * page_size );
+
+  // The backing memory (only touched pages are ever allocated)
+  FileDescriptor memory { ::CheckSystemCall( "memfd_create", memfd_create( "minnow-ring", MFD_CLOEXEC ) ) };
+  ::CheckSystemCall( "ftruncate", ftruncate( memory.fd_num(), static_cast<off_t>( size_ ) ) );
+
+  // Reserve twice the size in address space, then map the memory over each half.
+  base_ = static_cast<char*>(
+    check_mmap( "mmap", mmap( nullptr, 2 * size_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 ) ) );
+  try {
+    for ( char* const half : { base_, base_ + size_ } ) {
+      check_mmap( "mmap",
+                  mmap( half, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, memory.fd_num(), 0 ) );
+    }
+  } catch ( ... ) {
+    unmap();
+    throw;
+  }
+}
+
+MirroredBuffer::~MirroredBuffer()
+{
+  unmap();
+}
+
+void MirroredBuffer::unmap()
+{
+  if ( base_ != nullptr and munmap( base_, 2 * size_ ) < 0 ) {
+    // don't throw an exception from the destructor
+    cerr << "Exception destructing MirroredBuffer: " << unix_error { "munmap" }.what() << "\n";
+  }
+  base_ = nullptr;
+}
+
+MirroredBuffer::MirroredBuffer( const MirroredBuffer& other ) : MirroredBuffer( other.size_ )
+{
+  memcpy( base_, other.base_, size_ );
+}
+
+MirroredBuffer& MirroredBuffer::operator=( const MirroredBuffer& other )
+{
+  if ( this != &other ) {
+    *this = MirroredBuffer { other };
+  }
+  return *this;
+}
+
+MirroredBuffer::MirroredBuffer( MirroredBuffer&& other ) noexcept
+  : base_( exchange( other.base_, nullptr ) ), size_( other.size_ )
+{}
+
+MirroredBuffer& MirroredBuffer::operator=( MirroredBuffer&& other ) noexcept
+{
+  if ( this != &other ) {
+    unmap();
+    base_ = exchange( other.base_, nullptr );
+    size_ = other.size_;
+  }
+  return *this;
+}
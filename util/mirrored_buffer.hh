@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+//! \brief A ring buffer whose memory is mapped twice, back to back, in virtual memory
+//! \details The same `size()` bytes (a memfd) appear at data() and again at data() + size(), so the
+//! `size()` bytes starting at any offset below `size()` are contiguous, even when they wrap around the
+//! end of the ring. Reads and writes may therefore run past the first mapping into the second one.
+class MirroredBuffer
+{
+public:
+  //! Map a ring of at least `min_size` bytes (rounded up to a whole number of pages)
+  explicit MirroredBuffer( size_t min_size );
+  ~MirroredBuffer();
+
+  //! Copying maps a new ring of the same size and copies the contents
+  MirroredBuffer( const MirroredBuffer& other );
+  MirroredBuffer& operator=( const MirroredBuffer& other );
+  MirroredBuffer( MirroredBuffer&& other ) noexcept;
+  MirroredBuffer& operator=( MirroredBuffer&& other ) noexcept;
+
+  char* data() { return base_; }
+  const char* data() const { return base_; }
+  size_t size() const { return size_; } //!< Size of the ring (each of the two mappings)
+
+private:
+  char* base_ {};
+  size_t size_ {};
+
+  void unmap();
+};
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "address.hh"
+#include "byte_stream.hh"
+#include "congestion_control.hh"
 #include "wrapping_integers.hh"
 
 #include <cstddef>
@@ -11,14 +13,67 @@ class TCPConfig
 {
 public:
   static constexpr size_t DEFAULT_CAPACITY = 64000; //!< Default capacity
-  static constexpr size_t MAX_PAYLOAD_SIZE = 1000;  //!< Conservative max payload size for real Internet
+  static constexpr size_t MAX_PAYLOAD_SIZE = 1000;  //!< Default MSS: a conservative max payload for real Internet
+  static constexpr uint16_t MIN_MSS = 48;           //!< Smallest peer MSS we send by (as Linux's TCP_MIN_SND_MSS)
+  static constexpr uint16_t DEFAULT_MSS = 536;      //!< MSS every IPv4 host accepts (RFC 9293 section 3.7.1)
   static constexpr uint16_t TIMEOUT_DFLT = 1000;    //!< Default re-transmit timeout is 1 second
   static constexpr unsigned MAX_RETX_ATTEMPTS = 8;  //!< Maximum re-transmit attempts before giving up
+  static constexpr unsigned DUP_THRESH = 3;         //!< Duplicate acks (or segments SACKed) before a hole is lost
+  static constexpr uint64_t MIN_RTO_MS = 200;       //!< Default floor on the adaptive RTO (RFC 6298 says 1 s)
+  static constexpr uint64_t MAX_RTO_MS = 60000;     //!< Default ceiling on the adaptive RTO, including backoff
+  static constexpr uint8_t MAX_WINDOW_SCALE = 14;   //!< Largest window scale shift (RFC 7323 section 2.3)
+  static constexpr size_t TIMESTAMPS_LENGTH = 12;   //!< Bytes the timestamps option adds to every segment
+  static constexpr uint64_t ACK_DELAY_MS = 40;      //!< Longest a delayed ACK waits (RFC 1122 allows 500 ms)
+  static constexpr unsigned ACK_EVERY = 2;          //!< In-order segments that one delayed ACK may cover
+  static constexpr double PACING_SS_GAIN = 2.0;     //!< Pacing rate over window/SRTT in slow start (as in Linux)
+  static constexpr double PACING_CA_GAIN = 1.2;     //!< Pacing rate over window/SRTT otherwise
 
   uint16_t rt_timeout = TIMEOUT_DFLT;      //!< Initial value of the retransmission timeout, in milliseconds
   size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes
   size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes
   Wrap32 isn { 137 };                      //!< Default initial sequence number
+  uint16_t mss = MAX_PAYLOAD_SIZE;         //!< Largest payload to send or accept, offered on the SYN
+  bool sack = false;                       //!< Offer selective acknowledgments (RFC 2018), and use them to resend
+  bool adaptive_rto = false;               //!< Compute the RTO from measured RTTs (RFC 6298), from rt_timeout
+  uint64_t min_rto_ms = MIN_RTO_MS;        //!< Smallest adaptive RTO (lower it for networks with sub-ms RTTs)
+  uint64_t max_rto_ms = MAX_RTO_MS;        //!< Largest adaptive RTO, including backoff
+  bool fast_retransmit = false;            //!< Resend after DUP_THRESH duplicate acks, then NewReno recovery
+  bool window_scaling = false;             //!< Offer window scaling (RFC 7323), for recv_capacity over 64 KiB
+  bool timestamps = false;                 //!< Offer timestamps (RFC 7323): RTT samples from every ack, and PAWS
+  bool delayed_ack = false;                //!< Ack in-order data every ACK_EVERY segments or ACK_DELAY_MS
+  bool nagle = false;                      //!< Hold back a small segment while data is unacknowledged (RFC 896)
+  bool cork = false;                       //!< Hold back a small segment until the sender is flushed or uncorked
+  bool sws_avoidance = false;              //!< Avoid the silly window syndrome on both sides (RFC 1122 4.2.3.3-4)
+  bool pacing = false;                     //!< Spread new segments over the round trip instead of sending bursts
+  uint64_t pacing_rate = 0;                //!< Pacing rate in bytes per second (0: from the window and SRTT)
+  bool syn_cookies = true;                 //!< Answer SYNs with SYN cookies when a listener's SYN queue is full
+
+  //! Which algorithm limits the sender's bytes in flight, besides the receiver's window
+  CongestionControl::Algorithm congestion_control = CongestionControl::Algorithm::None;
+
+  //! How the outbound and inbound streams hold their bytes (Mirrored suits multi-megabyte capacities)
+  ByteStream::Storage send_storage = ByteStream::Storage::Ring;
+  ByteStream::Storage recv_storage = ByteStream::Storage::Chunks;
+
+  //! MSS that fills an IP datagram of `mtu` bytes, after the fixed IPv4 and TCP headers (RFC 6691). An MTU too
+  //! small for the default MSS gets the default anyway, and one past what the option can say gets its largest value.
+  static constexpr uint16_t mss_for_mtu( size_t mtu )
+  {
+    if ( mtu < 40 + size_t { DEFAULT_MSS } ) {
+      return DEFAULT_MSS;
+    }
+    return mtu - 40 > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>( mtu - 40 );
+  }
+
+  //! Smallest window scale that lets the 16-bit window field describe all of recv_capacity
+  uint8_t recv_window_scale() const
+  {
+    uint8_t scale = 0;
+    while ( scale < MAX_WINDOW_SCALE and ( recv_capacity >> scale ) > UINT16_MAX ) {
+      scale++;
+    }
+    return scale;
+  }
 };
 
 //! Config for classes derived from FdAdapter
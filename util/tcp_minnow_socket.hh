@@ -5,6 +5,7 @@
 #include "socket.hh"
 #include "tcp_config.hh"
 #include "tcp_peer.hh"
+#include "timer_fd.hh"
 #include "tuntap_adapter.hh"
 
 #include <atomic>
@@ -53,6 +54,21 @@ public:
   void set_reuseaddr() = delete;
   //!@}
 
+  //! Turn Nagle's algorithm on or off after connecting (the opposite of setting TCP_NODELAY)
+  void set_nagle( bool on )
+  {
+    _nagle.store( on );
+    _timer.set( {} ); // (wake the TCPPeer thread to apply it)
+  }
+
+  //! Cork or uncork the connection (like TCP_CORK): while corked, a write too small to fill a segment is held
+  //! back, and uncorking sends it
+  void set_cork( bool on )
+  {
+    _cork.store( on );
+    _timer.set( {} );
+  }
+
   // Return peer address from underlying datagram adapter
   const Address& peer_address() const { return _datagram_adapter.config().destination; }
 
@@ -73,6 +89,9 @@ private:
   //! eventloop that handles all the events (new inbound datagram, new outbound bytes, new inbound bytes)
   EventLoop _eventloop {};
 
+  //! Goes off when the TCPPeer next has something to do (or right away, when the owner needs its thread awake)
+  TimerFD _timer {};
+
   //! Process events while specified condition is true
   void _tcp_loop( const std::function<bool()>& condition );
 
@@ -87,6 +106,10 @@ private:
 
   std::atomic_bool _abort { false }; //!< Flag used by the owner to force the TCPPeer thread to shut down
 
+  std::atomic_bool _nagle { false }; //!< Nagle setting requested by the owner (applied by the TCPPeer thread)
+
+  std::atomic_bool _cork { false }; //!< Cork setting requested by the owner (applied by the TCPPeer thread)
+
   bool _inbound_shutdown { false }; //!< Has TCPMinnowSocket shut down the incoming data to the owner?
 
   bool _outbound_shutdown { false }; //!< Has the owner shut down the outbound data to the TCP connection?
@@ -2,6 +2,7 @@
 
 #include "exception.hh"
 
+#include <algorithm>
 #include <cstddef>
 #include <exception>
 #include <iostream>
@@ -10,34 +11,63 @@
 #include <sys/socket.h>
 #include <utility>
 
-static constexpr size_t TCP_TICK_MS = 10;
+// Once the TCPPeer has finished, the timer isn't watched, so look for an abort this often
+static constexpr int FINISHED_POLL_MS = 10;
 
-inline uint64_t timestamp_ms()
+inline uint64_t timestamp_us()
 {
   static_assert( std::is_same_v<std::chrono::steady_clock::duration, std::chrono::nanoseconds> );
 
-  return std::chrono::steady_clock::now().time_since_epoch().count() / 1000000;
+  return std::chrono::steady_clock::now().time_since_epoch().count() / 1000;
 }
 
 //! \param[in] condition is a function returning true if loop should continue
 template<TCPDatagramAdapter AdaptT>
 void TCPMinnowSocket<AdaptT>::_tcp_loop( const std::function<bool()>& condition )
 {
-  auto base_time = timestamp_ms();
+  const auto owner_requests = [&] {
+    return _abort or _nagle != _tcp->sender().nagle() or _cork != _tcp->sender().corked();
+  };
+
+  auto base_time = timestamp_us();
   while ( condition() ) {
-    auto ret = _eventloop.wait_next_event( TCP_TICK_MS );
+    if ( not _tcp.has_value() ) {
+      throw std::runtime_error( "_tcp_loop entered before TCPPeer initialized" );
+    }
+
+    // Sleep until the TCPPeer's or the datagram adapter's next deadline, unless an event comes first. The owner
+    // wakes this thread by setting the timer to go off right away, so look for its requests after setting the
+    // timer: either they are seen here, or the timer was set for them after this.
+    auto delay = _tcp->us_until_timer();
+    if ( const auto adapter_ms = _datagram_adapter.ms_until_timer() ) {
+      // (the adapter's clock is the rounded-down time of the last tick, which may be up to a ms before it)
+      const uint64_t adapter_us = *adapter_ms * 1000 - std::min( *adapter_ms * 1000, base_time % 1000 );
+      delay = std::min( delay.value_or( UINT64_MAX ), adapter_us );
+    }
+    if ( delay.has_value() ) {
+      _timer.set( std::chrono::microseconds { *delay } );
+    } else {
+      _timer.disarm();
+    }
+    const int timeout_ms = owner_requests() ? 0 : ( _tcp->active() ? -1 : FINISHED_POLL_MS );
+    auto ret = _eventloop.wait_next_event( timeout_ms );
     if ( ret == EventLoop::Result::Exit or _abort ) {
       break;
     }
 
-    if ( not _tcp.has_value() ) {
-      throw std::runtime_error( "_tcp_loop entered before TCPPeer initialized" );
+    // Apply any change the owner made to the Nagle and cork settings (uncorking may release a segment)
+    if ( _nagle != _tcp->sender().nagle() or _cork != _tcp->sender().corked() ) {
+      _tcp->set_nagle( _nagle );
+      _tcp->set_cork( _cork );
+      _tcp->push( [&]( auto x ) { _datagram_adapter.write( x ); } );
     }
 
+    // (The datagram adapter counts whole milliseconds: its ticks are the difference of the rounded-down times,
+    // so that no fractions are lost)
     if ( _tcp.value().active() ) {
-      const auto next_time = timestamp_ms();
-      _tcp.value().tick( next_time - base_time, [&]( auto x ) { _datagram_adapter.write( x ); } );
-      _datagram_adapter.tick( next_time - base_time );
+      const auto next_time = timestamp_us();
+      _tcp.value().tick_us( next_time - base_time, [&]( auto x ) { _datagram_adapter.write( x ); } );
+      _datagram_adapter.tick( next_time / 1000 - base_time / 1000 );
       base_time = next_time;
     }
   }
@@ -60,10 +90,12 @@ template<TCPDatagramAdapter AdaptT>
 void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
 {
   _tcp.emplace( config );
+  _nagle = config.nagle;
+  _cork = config.cork;
 
   // Set up the event loop
 
-  // There are three events to handle:
+  // There are four events to handle:
   //
   // 1) Incoming datagram received (needs to be given to TCPPeer::receive method)
   //
@@ -74,6 +106,9 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
   // 3) Incoming bytes reassembled by the Reassembler
   //    (needs to be read from the inbound_stream and written
   //    to the local stream socket back to the application)
+  //
+  // 4) The timer going off (the TCPPeer is ticked after every
+  //    event, so this only needs to wake the loop)
 
   // rule 1: read from filtered packet stream and dump into TCPConnection
   _eventloop.add_rule(
@@ -100,10 +135,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     _thread_data,
     Direction::In,
     [&] {
-      std::string data;
-      data.resize( _tcp->outbound_writer().available_capacity() );
-      _thread_data.read( data );
-      _tcp->outbound_writer().push( move( data ) );
+      fill( _tcp->outbound_writer(), _thread_data );
 
       if ( _thread_data.eof() ) {
         _tcp->outbound_writer().close();
@@ -138,13 +170,11 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     Direction::Out,
     [&] {
       Reader& inbound = _tcp->inbound_reader();
-      // Write from the inbound_stream into
-      // the pipe, handling the possibility of a partial
-      // write (i.e., only pop what was actually written).
+      // Write everything buffered in the inbound_stream into
+      // the pipe with one writev, handling the possibility of a
+      // partial write (i.e., only pop what was actually written).
       if ( inbound.bytes_buffered() ) {
-        const std::string_view buffer = inbound.peek();
-        const auto bytes_written = _thread_data.write( buffer );
-        inbound.pop( bytes_written );
+        drain( inbound, _thread_data );
       }
 
       if ( inbound.is_finished() or inbound.has_error() ) {
@@ -166,6 +196,10 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
       std::cerr << "DEBUG: minnow inbound stream had error.\n";
       _tcp->inbound_reader().set_error();
     } );
+
+  // rule 4: the timer went off
+  _eventloop.add_rule(
+    "TCP timer", _timer, Direction::In, [&] { _timer.read_expirations(); }, [&] { return _tcp->active(); } );
 }
 
 //! \brief Call [socketpair](\ref man2::socketpair) and return connected Unix-domain sockets of specified type
@@ -194,6 +228,7 @@ TCPMinnowSocket<AdaptT>::~TCPMinnowSocket()
       std::cerr << "Warning: unclean shutdown of TCPMinnowSocket\n";
       // force the other side to exit
       _abort.store( true );
+      _timer.set( {} ); // (wake it: it may be waiting with no deadline)
       _tcp_thread.join();
     }
   } catch ( const std::exception& e ) {
@@ -7,6 +7,8 @@
 #include "tcp_sender.hh"
 #include "tcp_sender_message.hh"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <optional>
 
@@ -27,24 +29,54 @@ public:
   using TransmitFunction = std::function<void( TCPMessage )>;
 
   /* Passthrough methods */
-  void push( const TransmitFunction& transmit ) { sender_.push( make_send( transmit ) ); }
-  void tick( uint64_t t, const TransmitFunction& transmit )
+  void push( const TransmitFunction& transmit )
+  {
+    sender_.push( make_send( transmit ) );
+    send_window_update( transmit );
+  }
+  void tick( uint64_t t, const TransmitFunction& transmit ) { tick_us( t * 1000, transmit ); }
+  void tick_us( uint64_t t, const TransmitFunction& transmit )
   {
     cumulative_time_ += t;
-    sender_.tick( t, make_send( transmit ) );
+    sender_.tick_us( t, make_send( transmit ) );
+
+    // A delayed ACK is due
+    if ( segments_unacked_ > 0 and cumulative_time_ >= ack_deadline_ ) {
+      send( sender_.make_empty_message(), transmit );
+    }
+
+    send_window_update( transmit );
   }
-  bool has_ackno() const { return receiver_.send().ackno.has_value(); }
+  bool has_ackno() const { return receiver_.ackno().has_value(); }
+  void set_nagle( bool on ) { sender_.set_nagle( on ); }
+  void set_cork( bool on ) { sender_.set_cork( on ); }
 
   /* Is the peer still active? */
   bool active() const
   {
     const bool any_errors = receiver_.reader().has_error() or sender_.writer().has_error();
-    const bool sender_active = sender_.sequence_numbers_in_flight() or not sender_.reader().is_finished();
-    const bool receiver_active = not receiver_.writer().is_closed();
-    const bool lingering
-      = linger_after_streams_finish_ and ( cumulative_time_ < time_of_last_receipt_ + 10UL * cfg_.rt_timeout );
+    const bool lingering = linger_after_streams_finish_ and cumulative_time_ < linger_deadline();
 
-    return ( not any_errors ) and ( sender_active or receiver_active or lingering );
+    return ( not any_errors ) and ( streams_active() or lingering );
+  }
+
+  /* How many microseconds until tick() next has something to do: retransmit, send a delayed ACK or paced data,
+   * or stop lingering. (Nothing, until a segment is received or pushed, if there is no value.) */
+  std::optional<uint64_t> us_until_timer() const
+  {
+    std::optional<uint64_t> result = sender_.us_until_timeout();
+    const auto sooner = [&]( uint64_t us ) { result = std::min( result.value_or( us ), us ); };
+
+    if ( sender_.pacing_delay_us() > 0 ) {
+      sooner( sender_.pacing_delay_us() );
+    }
+    if ( segments_unacked_ > 0 ) {
+      sooner( ack_deadline_ - std::min( ack_deadline_, cumulative_time_ ) );
+    }
+    if ( linger_after_streams_finish_ and not streams_active() and active() ) {
+      sooner( linger_deadline() - cumulative_time_ );
+    }
+    return result;
   }
 
   void receive( TCPMessage msg, const TransmitFunction& transmit )
@@ -61,14 +93,31 @@ public:
 
     // If SenderMessage is a "keep-alive" (with intentionally invalid seqno), make sure to reply.
     // (N.B. orthodox TCP rules require a reply on any unacceptable segment.)
-    const auto our_ackno = receiver_.send().ackno;
+    const auto our_ackno = receiver_.ackno();
     need_send_ |= ( our_ackno.has_value() and msg.sender->seqno + 1 == our_ackno.value() );
 
     // Give incoming TCPSenderMessage to receiver.
+    const bool data_only = not msg.sender->SYN and not msg.sender->FIN and not msg.sender->payload.empty();
+    const uint64_t payload_size = msg.sender->payload.size();
+    const bool with_data = msg.sender->sequence_length() > 0;
     receiver_.receive( std::move( msg.sender ) );
 
+    // With delayed ACKs, in-order data is acked along with the next segment or after a delay (RFC 5681 4.2).
+    // Anything else is acked right away: out-of-order data (so the sender sees a duplicate ack), data that fills
+    // part of a hole, a SYN or FIN, or a segment that didn't advance the ackno.
+    if ( cfg_.delayed_ack and data_only and our_ackno.has_value() ) {
+      const bool in_order = receiver_.ackno() == our_ackno.value() + payload_size
+                            and receiver_.reassembler().count_bytes_pending() == 0;
+      if ( in_order and ++segments_unacked_ < TCPConfig::ACK_EVERY ) {
+        need_send_ = false;
+        if ( segments_unacked_ == 1 ) {
+          ack_deadline_ = cumulative_time_ + TCPConfig::ACK_DELAY_MS * 1000;
+        }
+      }
+    }
+
     // Give incoming TCPReceiverMessage to sender.
-    sender_.receive( msg.receiver );
+    sender_.receive( msg.receiver, with_data );
 
     // Send reply if needed.
     push( transmit );
@@ -88,18 +137,52 @@ public:
 
 private:
   TCPConfig cfg_;
-  TCPSender sender_ { ByteStream { cfg_.send_capacity }, cfg_.isn, cfg_.rt_timeout };
-  TCPReceiver receiver_ { Reassembler { ByteStream { cfg_.recv_capacity } } };
+  TCPSender sender_ { ByteStream { cfg_.send_capacity, cfg_.send_storage }, cfg_.isn, cfg_.rt_timeout, cfg_ };
+  TCPReceiver receiver_ { Reassembler { ByteStream { cfg_.recv_capacity, cfg_.recv_storage } }, cfg_ };
 
   bool need_send_ {};
+  uint64_t segments_unacked_ {}; // in-order segments received since our last ACK (with delayed ACKs)
+  uint64_t ack_deadline_ {};     // when the oldest of them must be acked
+  uint64_t advertised_window_ {}; // bytes our window offered in the last segment we sent
 
   void send( const TCPSenderMessage& sender_message, const TransmitFunction& transmit )
   {
-    transmit( { borrow( sender_message ), receiver_.send() } );
+    receiver_.open_window();
+    TCPReceiverMessage receiver_message = receiver_.send( sender_.syn_acked() );
+    receiver_.note_ack_sent( receiver_message );
+    transmit( { borrow( sender_message ), std::move( receiver_message ) } );
     need_send_ = false;
+    segments_unacked_ = 0; // (every segment carries the current ackno)
+    advertised_window_ = receiver_.window();
+  }
+
+  // Once the application has freed up receive space, tell the peer right away (never with a delayed ACK) when
+  // the window opens by a segment or half the buffer, the step SWS avoidance offers it in. As in Linux, this is
+  // only worth a segment if the window we last offered had shrunk below half the buffer; otherwise the sender
+  // isn't waiting for it.
+  void send_window_update( const TransmitFunction& transmit )
+  {
+    if ( not has_ackno() or receiver_.writer().is_closed() or not active() ) {
+      return;
+    }
+
+    receiver_.open_window();
+    const uint64_t step = std::min<uint64_t>( cfg_.mss, cfg_.recv_capacity / 2 );
+    if ( advertised_window_ < cfg_.recv_capacity / 2 and receiver_.window() >= advertised_window_ + step ) {
+      send( sender_.make_empty_message(), transmit );
+    }
   }
 
   bool linger_after_streams_finish_ { true }; // one peer may need to linger to make sure all closure conditions met
-  uint64_t cumulative_time_ {};
+  uint64_t cumulative_time_ {}; // (all times are in microseconds)
   uint64_t time_of_last_receipt_ {};
+
+  bool streams_active() const
+  {
+    const bool sender_active = sender_.sequence_numbers_in_flight() or not sender_.reader().is_finished();
+    const bool receiver_active = not receiver_.writer().is_closed();
+    return sender_active or receiver_active;
+  }
+
+  uint64_t linger_deadline() const { return time_of_last_receipt_ + 10UL * cfg_.rt_timeout * 1000; }
 };
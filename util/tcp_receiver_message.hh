@@ -2,21 +2,37 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <utility>
+#include <vector>
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
  *
- * It contains three fields:
+ * It contains seven fields:
  *
  * 1) The acknowledgment number (ackno): the *next* sequence number needed by the TCP Receiver.
  *    This is an optional field that is empty if the TCPReceiver hasn't yet received the Initial Sequence Number.
  *
  * 2) The window size. This is the number of sequence numbers that the TCP receiver is interested
  *    to receive, starting from the ackno if present. The maximum value is 65,535 (UINT16_MAX from
- *    the <cstdint> header).
+ *    the <cstdint> header), in units of 2^(window scale) bytes once window scaling is in effect.
  *
  * 3) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
+ *
+ * 4) The SACK blocks (RFC 2018): the [left edge, right edge) sequence numbers of data the receiver holds
+ *    beyond the ackno, most recently received first. Only sent if the peer's SYN said SACK was permitted.
+ *
+ * 5) The window scale (RFC 7323) from a SYN segment: how far to shift the window_size of the segments
+ *    that follow (the SYN's own window isn't scaled). Filled in when the segment is parsed from the wire.
+ *
+ * 6) The timestamp echo (TSecr, RFC 7323): the TSval of the segment that most recently advanced the
+ *    ackno, so the sender can time the round trip. Only sent once both SYNs have carried a timestamp.
+ *
+ * 7) The maximum segment size from a SYN segment: the largest payload the sender may put in a segment.
+ *    Filled in when the segment is parsed from the wire.
  */
 
 struct TCPReceiverMessage
@@ -24,4 +40,10 @@ struct TCPReceiverMessage
   std::optional<Wrap32> ackno {};
   uint16_t window_size {};
   bool RST {};
+  std::vector<std::pair<Wrap32, Wrap32>> sack {};
+  std::optional<uint8_t> window_scale {};
+  std::optional<uint32_t> timestamp_echo {};
+  std::optional<uint16_t> mss {};
+
+  static constexpr size_t MAX_SACK_BLOCKS = 4; // Most blocks that fit in the TCP header's option space
 };
@@ -3,12 +3,167 @@
 #include "helpers.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
+#include <concepts>
 #include <sstream>
 
 using namespace std;
 
 static_assert( !( TCPSegment::HEADER_LENGTH & 0x03 ) ); // header length must be divisible by 4
 
+class Wrap32Serializable : public Wrap32
+{
+public:
+  uint32_t raw_value() const { return raw_value_; }
+};
+
+namespace {
+// TCP option kinds (https://www.iana.org/assignments/tcp-parameters)
+enum OptionKind : uint8_t
+{
+  OPT_END = 0,
+  OPT_NOP = 1,
+  OPT_MSS = 2,            // RFC 9293
+  OPT_WINDOW_SCALE = 3,   // RFC 7323
+  OPT_SACK_PERMITTED = 4, // RFC 2018
+  OPT_SACK = 5,           // RFC 2018
+  OPT_TIMESTAMPS = 8,     // RFC 7323
+};
+
+constexpr size_t MAX_OPTIONS_LENGTH = 40; // the header's data offset field can describe at most 60 bytes
+
+void parse_options( Parser& parser, size_t options_length, TCPMessage& message )
+{
+  while ( options_length > 0 and not parser.has_error() ) {
+    uint8_t kind {};
+    parser.integer( kind );
+    options_length--;
+
+    if ( kind == OPT_END ) {
+      break;
+    }
+    if ( kind == OPT_NOP ) {
+      continue;
+    }
+
+    uint8_t length {};
+    parser.integer( length );
+    if ( length < 2 or length - 1U > options_length ) {
+      parser.set_error();
+      return;
+    }
+    options_length -= length - 1U;
+    const size_t body_length = length - 2U;
+
+    if ( kind == OPT_MSS and body_length == 2 ) {
+      uint16_t mss {};
+      parser.integer( mss );
+      if ( message.sender->SYN ) { // the option means nothing on other segments
+        message.sender->mss = message.receiver->mss = mss;
+      }
+    } else if ( kind == OPT_WINDOW_SCALE and body_length == 1 ) {
+      uint8_t shift {};
+      parser.integer( shift );
+      if ( message.sender->SYN ) { // the option means nothing on other segments
+        message.sender->window_scale = message.receiver->window_scale = shift;
+      }
+    } else if ( kind == OPT_TIMESTAMPS and body_length == 8 ) {
+      uint32_t value {};
+      uint32_t echo {};
+      parser.integer( value );
+      parser.integer( echo );
+      message.sender->timestamp = value;
+      message.receiver->timestamp_echo = echo; // (meaningless, and zero, on a SYN that acks nothing)
+    } else if ( kind == OPT_SACK_PERMITTED and body_length == 0 ) {
+      message.sender->SACK_permitted = true;
+    } else if ( kind == OPT_SACK and body_length % 8 == 0 ) {
+      for ( size_t i = 0; i < body_length / 8; i++ ) {
+        uint32_t left {};
+        uint32_t right {};
+        parser.integer( left );
+        parser.integer( right );
+        message.receiver->sack.emplace_back( Wrap32 { left }, Wrap32 { right } );
+      }
+    } else {
+      parser.remove_prefix( body_length ); // skip options we don't understand
+    }
+  }
+
+  // skip any padding after the end-of-options marker
+  parser.remove_prefix( options_length );
+}
+
+template<std::unsigned_integral T>
+void append( string& out, T val )
+{
+  for ( size_t i = sizeof( T ); i > 0; i-- ) {
+    out.push_back( static_cast<char>( val >> ( ( i - 1 ) * 8 ) ) );
+  }
+}
+
+string serialize_options( const TCPMessage& message )
+{
+  string options;
+
+  // Each option is preceded by NOPs so that it (and the header) stays 4-byte aligned.
+  if ( message.sender->SYN and message.sender->mss.has_value() ) {
+    options += { OPT_MSS, 4 };
+    append( options, *message.sender->mss );
+  }
+
+  if ( message.sender->SYN and message.sender->window_scale.has_value() ) {
+    options += { OPT_NOP, OPT_WINDOW_SCALE, 3, static_cast<char>( *message.sender->window_scale ) };
+  }
+
+  if ( message.sender->timestamp.has_value() ) {
+    options += { OPT_NOP, OPT_NOP, OPT_TIMESTAMPS, 10 };
+    append( options, *message.sender->timestamp );
+    append( options, message.receiver->timestamp_echo.value_or( 0 ) );
+  }
+
+  if ( message.sender->SYN and message.sender->SACK_permitted ) {
+    options += { OPT_NOP, OPT_NOP, OPT_SACK_PERMITTED, 2 };
+  }
+
+  if ( not message.receiver->sack.empty() ) {
+    const size_t blocks = min( message.receiver->sack.size(), ( MAX_OPTIONS_LENGTH - options.size() - 4 ) / 8 );
+    options += { OPT_NOP, OPT_NOP, OPT_SACK, static_cast<char>( 2 + 8 * blocks ) };
+    for ( size_t i = 0; i < blocks; i++ ) {
+      const auto& [left, right] = message.receiver->sack[i];
+      append( options, Wrap32Serializable { left }.raw_value() );
+      append( options, Wrap32Serializable { right }.raw_value() );
+    }
+  }
+
+  while ( options.size() % 4 ) {
+    options.push_back( OPT_END );
+  }
+  return options;
+}
+
+// The length of serialize_options( message ), without building the string.
+size_t options_length( const TCPMessage& message )
+{
+  size_t length = 0;
+  if ( message.sender->SYN and message.sender->mss.has_value() ) {
+    length += 4;
+  }
+  if ( message.sender->SYN and message.sender->window_scale.has_value() ) {
+    length += 4;
+  }
+  if ( message.sender->timestamp.has_value() ) {
+    length += 12;
+  }
+  if ( message.sender->SYN and message.sender->SACK_permitted ) {
+    length += 4;
+  }
+  if ( not message.receiver->sack.empty() ) {
+    length += 4 + 8 * min( message.receiver->sack.size(), ( MAX_OPTIONS_LENGTH - length - 4 ) / 8 );
+  }
+  return ( length + 3 ) & ~size_t { 3 };
+}
+} // namespace
+
 void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum )
 {
   /* verify checksum */
@@ -48,29 +203,23 @@ void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum
   parser.integer( udinfo.cksum );
   parser.integer( raw16 ); // urgent pointer
 
-  // skip any options or anything extra in the header
   if ( data_offset < ( HEADER_LENGTH >> 2 ) ) {
     parser.set_error();
     return;
   }
-  parser.remove_prefix( data_offset * 4 - HEADER_LENGTH );
+  parse_options( parser, data_offset * 4 - HEADER_LENGTH, message );
 
   parser.concatenate_all_remaining( message.sender->payload );
 }
 
-class Wrap32Serializable : public Wrap32
-{
-public:
-  uint32_t raw_value() const { return raw_value_; }
-};
-
 void TCPSegment::serialize( Serializer& serializer ) const
 {
   serializer.integer( udinfo.src_port );
   serializer.integer( udinfo.dst_port );
   serializer.integer( Wrap32Serializable { message.sender->seqno }.raw_value() );
   serializer.integer( Wrap32Serializable { message.receiver->ackno.value_or( Wrap32 { 0 } ) }.raw_value() );
-  serializer.integer( uint8_t { ( HEADER_LENGTH >> 2 ) << 4 } ); // data offset
+  string options = serialize_options( message );
+  serializer.integer( static_cast<uint8_t>( ( ( HEADER_LENGTH + options.size() ) >> 2 ) << 4 ) ); // data offset
   const bool reset = message.sender->RST or message.receiver->RST;
   const uint8_t flags = ( message.receiver->ackno.has_value() ? 0b0001'0000U : 0 ) | ( reset ? 0b0000'0100U : 0 )
                         | ( message.sender->SYN ? 0b0000'0010U : 0 ) | ( message.sender->FIN ? 0b0000'0001U : 0 );
@@ -78,9 +227,15 @@ void TCPSegment::serialize( Serializer& serializer ) const
   serializer.integer( message.receiver->window_size );
   serializer.integer( udinfo.cksum );
   serializer.integer( uint16_t { 0 } ); // urgent pointer
+  serializer.buffer( move( options ) );
   serializer.buffer( message.sender->payload );
 }
 
+size_t TCPSegment::header_length() const
+{
+  return HEADER_LENGTH + options_length( message );
+}
+
 void TCPSegment::compute_checksum( uint32_t datagram_layer_pseudo_checksum )
 {
   udinfo.cksum = 0;
@@ -100,6 +255,18 @@ string TCPSegment::to_string() const
   if ( message.sender->SYN ) {
     ss << " +SYN";
   }
+  if ( message.sender->mss.has_value() ) {
+    ss << " MSS=" << *message.sender->mss;
+  }
+  if ( message.sender->window_scale.has_value() ) {
+    ss << " +WSCALE=" << +*message.sender->window_scale;
+  }
+  if ( message.sender->SACK_permitted ) {
+    ss << " +SACK_PERM";
+  }
+  if ( message.sender->timestamp.has_value() ) {
+    ss << " TS<" << *message.sender->timestamp << "," << message.receiver->timestamp_echo.value_or( 0 ) << ">";
+  }
   if ( not message.sender->payload.empty() ) {
     ss << " payload=\"" << pretty_print( message.sender->payload ) << "\"";
   }
@@ -113,6 +280,10 @@ string TCPSegment::to_string() const
   if ( ackno.has_value() ) {
     ss << " ACK<" << Wrap32Serializable { *ackno }.raw_value() << ">";
   }
+  for ( const auto& [left, right] : message.receiver->sack ) {
+    ss << " SACK<" << Wrap32Serializable { left }.raw_value() << "-" << Wrap32Serializable { right }.raw_value()
+       << ">";
+  }
   ss << " winsize=" << message.receiver->window_size;
   ss << " src=" << udinfo.src_port << " dst=" << udinfo.dst_port;
   return ss.str();
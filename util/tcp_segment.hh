@@ -29,6 +29,9 @@ struct TCPSegment
 
   static constexpr uint8_t HEADER_LENGTH = 20; // TCP header length, not including options
 
+  // Length of the serialized header, including options (but not the payload)
+  size_t header_length() const;
+
   // Return a string containing a summary in human-readable format
   std::string to_string() const;
 };
@@ -2,12 +2,14 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstdint>
+#include <optional>
 #include <string>
 
 /*
  * The TCPSenderMessage structure contains the information sent from a TCP sender to its receiver.
  *
- * It contains five fields:
+ * It contains nine fields:
  *
  * 1) The sequence number (seqno) of the beginning of the segment. If the SYN flag is set, this is the
  *    sequence number of the SYN flag. Otherwise, it's the sequence number of the beginning of the payload.
@@ -20,6 +22,18 @@
  * 4) The FIN flag. If set, the payload represents the ending of the byte stream.
  *
  * 5) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
+ *
+ * 6) The SACK-permitted option (RFC 2018). Only meaningful with SYN: the sender can make sense of
+ *    SACK blocks in the peer's TCPReceiverMessages.
+ *
+ * 7) The window scale option (RFC 7323). Only meaningful with SYN: the sender's end can handle scaled
+ *    windows, and will advertise its own windows shifted right by this many bits.
+ *
+ * 8) The timestamp (TSval, RFC 7323): the sender's clock when it sent the segment. Sent on the SYN to
+ *    offer timestamps, and on every segment once both SYNs have carried one.
+ *
+ * 9) The maximum segment size option (RFC 9293 section 3.7.1). Only meaningful with SYN: the largest
+ *    payload the sender's end will accept in one segment.
  */
 
 struct TCPSenderMessage
@@ -32,6 +46,11 @@ struct TCPSenderMessage
 
   bool RST {};
 
+  bool SACK_permitted {};
+  std::optional<uint8_t> window_scale {};
+  std::optional<uint32_t> timestamp {};
+  std::optional<uint16_t> mss {};
+
   // How many sequence numbers does this segment use?
   size_t sequence_length() const { return SYN + payload.size() + FIN; }
 };
@@ -0,0 +1,43 @@
+#include "timer_fd.hh"
+#include "exception.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <sys/timerfd.h>
+
+using namespace std;
+using namespace std::chrono;
+
+TimerFD::TimerFD()
+  : FileDescriptor( ::CheckSystemCall( "timerfd_create", timerfd_create( CLOCK_MONOTONIC, TFD_CLOEXEC ) ) )
+{
+  set_blocking( false );
+}
+
+void TimerFD::set( nanoseconds delay )
+{
+  // (A zero it_value would disarm the timer instead)
+  const nanoseconds::rep ns = max( delay.count(), nanoseconds::rep { 1 } );
+  itimerspec spec {};
+  spec.it_value.tv_sec = static_cast<time_t>( ns / 1'000'000'000 );
+  spec.it_value.tv_nsec = static_cast<long>( ns % 1'000'000'000 );
+  CheckSystemCall( "timerfd_settime", timerfd_settime( fd_num(), 0, &spec, nullptr ) );
+}
+
+void TimerFD::disarm()
+{
+  const itimerspec spec {};
+  CheckSystemCall( "timerfd_settime", timerfd_settime( fd_num(), 0, &spec, nullptr ) );
+}
+
+uint64_t TimerFD::read_expirations()
+{
+  array<char, sizeof( uint64_t )> buffer {};
+  if ( read( buffer ) != buffer.size() ) {
+    return 0; // (not readable: the timer hasn't gone off)
+  }
+  uint64_t expirations = 0;
+  memcpy( &expirations, buffer.data(), buffer.size() );
+  return expirations;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "file_descriptor.hh"
+
+#include <chrono>
+#include <cstdint>
+
+//! A FileDescriptor to a [timerfd](\ref man2::timerfd_create): it becomes readable when the time it was set for
+//! comes, so an EventLoop can wait for a deadline along with its other events.
+class TimerFD : public FileDescriptor
+{
+public:
+  //! Create a timer on the monotonic clock (the one std::chrono::steady_clock reads), not yet set
+  TimerFD();
+
+  //! Go off once, `delay` from now (right away if it is zero), replacing any time the timer was set for. Other
+  //! threads may call this to wake the thread that is waiting on the timer.
+  void set( std::chrono::nanoseconds delay );
+
+  //! Don't go off
+  void disarm();
+
+  //! Acknowledge that the timer went off (so it is no longer readable), and return how many times it did
+  uint64_t read_expirations();
+};
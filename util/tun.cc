@@ -6,6 +6,7 @@
 #include <linux/if.h>
 #include <linux/if_tun.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 
 static constexpr const char* CLONEDEV = "/dev/net/tun";
 
@@ -22,7 +23,7 @@ using namespace std;
 //! as root before calling this function.
 
 TunTapFD::TunTapFD( const string& devname, const bool is_tun )
-  : FileDescriptor( ::CheckSystemCall( "open", open( CLONEDEV, O_RDWR | O_CLOEXEC ) ) )
+  : FileDescriptor( ::CheckSystemCall( "open", open( CLONEDEV, O_RDWR | O_CLOEXEC ) ) ), devname_( devname )
 {
   struct ifreq tun_req
   {};
@@ -36,3 +37,18 @@ TunTapFD::TunTapFD( const string& devname, const bool is_tun )
 
   CheckSystemCall( "ioctl", ioctl( fd_num(), TUNSETIFF, static_cast<void*>( &tun_req ) ) );
 }
+
+uint16_t TunTapFD::mtu() const
+{
+  // The MTU belongs to the network interface, which any socket can ask about
+  const FileDescriptor sock { CheckSystemCall( "socket", socket( AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0 ) ) };
+
+  struct ifreq mtu_req
+  {};
+
+  strncpy( static_cast<char*>( mtu_req.ifr_name ), devname_.data(), IFNAMSIZ - 1 );
+  mtu_req.ifr_name[IFNAMSIZ - 1] = '\0';
+
+  CheckSystemCall( "ioctl", ioctl( sock.fd_num(), SIOCGIFMTU, static_cast<void*>( &mtu_req ) ) );
+  return static_cast<uint16_t>( mtu_req.ifr_mtu );
+}
@@ -2,6 +2,7 @@
 
 #include "file_descriptor.hh"
 
+#include <cstdint>
 #include <string>
 
 //! A FileDescriptor to a [Linux TUN/TAP](https://www.kernel.org/doc/Documentation/networking/tuntap.txt) device
@@ -11,6 +12,12 @@ public:
   //! Open an existing persistent [TUN or TAP
   //! device](https://www.kernel.org/doc/Documentation/networking/tuntap.txt).
   explicit TunTapFD( const std::string& devname, bool is_tun );
+
+  //! The device's MTU: the largest datagram (TUN) or frame payload (TAP) it carries
+  uint16_t mtu() const;
+
+private:
+  std::string devname_;
 };
 
 //! A FileDescriptor to a [Linux TUN](https://www.kernel.org/doc/Documentation/networking/tuntap.txt) device